@@ -0,0 +1,339 @@
+#ifndef MY_CONCURRENT_LIST
+#define MY_CONCURRENT_LIST
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace my {
+namespace detail {
+
+// Hazard pointers (M. Michael, 2004) for the nodes of one container. An
+// operation acquires a record, publishes in it the nodes it is about to
+// dereference and releases it when done. Unlinked nodes are retired into
+// the record and deleted once no record publishes them. The retired nodes
+// stay with the record between operations, so records are never freed
+// before the domain.
+template <typename Node, std::size_t K>
+class hazard_domain {
+   public:
+    struct record {
+        std::atomic<Node*> hazard[K];
+        std::atomic<bool> active{true};
+        record* next = nullptr;
+        std::vector<Node*> retired;
+
+        record() {
+            for (auto& h : hazard) {
+                h.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    hazard_domain() = default;
+    hazard_domain(hazard_domain const&) = delete;
+    hazard_domain& operator=(hazard_domain const&) = delete;
+
+    ~hazard_domain() {
+        record* r = records.load(std::memory_order_acquire);
+        while (r != nullptr) {
+            record* next = r->next;
+            for (Node* p : r->retired) {
+                delete p;
+            }
+            delete r;
+            r = next;
+        }
+    }
+
+    record* acquire() {
+        for (record* r = records.load(std::memory_order_acquire); r != nullptr;
+             r = r->next) {
+            bool expected = false;
+            if (!r->active.load(std::memory_order_relaxed) &&
+                r->active.compare_exchange_strong(expected, true,
+                                                  std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        record* r = new record;
+        record* first = records.load(std::memory_order_relaxed);
+        do {
+            r->next = first;
+        } while (!records.compare_exchange_weak(first, r,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+        record_count.fetch_add(1, std::memory_order_relaxed);
+        return r;
+    }
+
+    void release(record* r) noexcept {
+        for (auto& h : r->hazard) {
+            h.store(nullptr, std::memory_order_release);
+        }
+        r->active.store(false, std::memory_order_release);
+    }
+
+    // Publishes the node src points to in slot i and returns the value of
+    // src, which may carry a mark in its low bit; the published pointer is
+    // unmarked. The node is safe to dereference as long as it was still
+    // reachable when src was read the second time.
+    static Node* protect(record* r, std::size_t i,
+                         std::atomic<Node*> const& src) noexcept {
+        Node* p = src.load();
+        for (;;) {
+            r->hazard[i].store(unmarked(p));
+            Node* again = src.load();
+            if (again == p) {
+                return p;
+            }
+            p = again;
+        }
+    }
+
+    void retire(record* r, Node* p) {
+        r->retired.push_back(p);
+        if (r->retired.size() >=
+            64 + 2 * K * record_count.load(std::memory_order_relaxed)) {
+            scan(r);
+        }
+    }
+
+    static Node* marked(Node* p) noexcept {
+        return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(p) |
+                                       1);
+    }
+    static Node* unmarked(Node* p) noexcept {
+        return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(p) &
+                                       ~std::uintptr_t(1));
+    }
+    static bool is_marked(Node* p) noexcept {
+        return (reinterpret_cast<std::uintptr_t>(p) & 1) != 0;
+    }
+
+   private:
+    std::atomic<record*> records{nullptr};
+    std::atomic<std::size_t> record_count{0};
+
+    void scan(record* r) {
+        std::vector<Node*> in_use;
+        for (record* other = records.load(std::memory_order_acquire);
+             other != nullptr; other = other->next) {
+            for (auto& h : other->hazard) {
+                if (Node* p = h.load()) {
+                    in_use.push_back(p);
+                }
+            }
+        }
+        std::sort(in_use.begin(), in_use.end());
+        auto keep = std::partition(
+            r->retired.begin(), r->retired.end(), [&in_use](Node* p) {
+                return std::binary_search(in_use.begin(), in_use.end(), p);
+            });
+        for (auto it = keep; it != r->retired.end(); ++it) {
+            delete *it;
+        }
+        r->retired.erase(keep, r->retired.end());
+    }
+};
+
+}  // namespace detail
+
+// Lock-free list for producers and consumers on several threads: push at
+// either end, pop at the front and traverse without any lock. The layout is
+// the Michael-Scott queue: head points to a dummy node in front of the
+// first element and a pop turns the first element into the new dummy.
+// A pop marks the link out of the old dummy before moving head, which makes
+// a concurrent push_front on that dummy fail and retry. Removed nodes are
+// reclaimed through hazard pointers, so nothing is freed while another
+// thread may still read it.
+//
+// Elements are never modified once pushed: try_pop_front copies the value
+// out, because a traversal may be reading it at the same time.
+template <typename T>
+class concurrent_list {
+   private:
+    struct node {
+        std::atomic<node*> next{nullptr};
+        bool engaged = false;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        node() = default;
+        template <typename... Args>
+        explicit node(int, Args&&... args) {
+            ::new (static_cast<void*>(storage))
+                T(std::forward<Args>(args)...);
+            engaged = true;
+        }
+        ~node() {
+            if (engaged) {
+                value().~T();
+            }
+        }
+
+        T& value() { return *reinterpret_cast<T*>(storage); }
+    };
+
+    using domain = detail::hazard_domain<node, 2>;
+    using record = typename domain::record;
+
+    // releases the hazard record at the end of an operation, also when the
+    // visitor of for_each throws
+    struct guard {
+        domain& d;
+        record* r;
+        explicit guard(domain& dom) : d(dom), r(dom.acquire()) {}
+        ~guard() { d.release(r); }
+        guard(guard const&) = delete;
+        guard& operator=(guard const&) = delete;
+    };
+
+    // const traversals take records too, and help move head past a
+    // dummy being popped
+    mutable domain hazards;
+    mutable std::atomic<node*> head;
+    std::atomic<node*> tail;
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    concurrent_list() {
+        node* dummy = new node;
+        head.store(dummy, std::memory_order_relaxed);
+        tail.store(dummy, std::memory_order_relaxed);
+    }
+
+    concurrent_list(concurrent_list const&) = delete;
+    concurrent_list& operator=(concurrent_list const&) = delete;
+
+    // no other thread may use the list any more
+    ~concurrent_list() {
+        node* cur = head.load(std::memory_order_relaxed);
+        while (cur != nullptr) {
+            node* next = domain::unmarked(cur->next.load());
+            delete cur;
+            cur = next;
+        }
+    }
+
+    void push_back(T const& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        node* n = new node(0, std::forward<Args>(args)...);
+        guard g(hazards);
+        for (;;) {
+            node* last = domain::protect(g.r, 0, tail);
+            node* next = last->next.load();
+            if (next != nullptr) {
+                // tail lags behind, help it along
+                tail.compare_exchange_weak(last, domain::unmarked(next));
+                continue;
+            }
+            if (last->next.compare_exchange_weak(next, n)) {
+                tail.compare_exchange_strong(last, n);
+                return;
+            }
+        }
+    }
+
+    void push_front(T const& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    template <typename... Args>
+    void emplace_front(Args&&... args) {
+        node* n = new node(0, std::forward<Args>(args)...);
+        guard g(hazards);
+        for (;;) {
+            node* dummy = domain::protect(g.r, 0, head);
+            node* first = dummy->next.load();
+            if (domain::is_marked(first)) {
+                // the dummy is being popped, help move head
+                head.compare_exchange_weak(dummy, domain::unmarked(first));
+                continue;
+            }
+            n->next.store(first, std::memory_order_relaxed);
+            if (dummy->next.compare_exchange_weak(first, n)) {
+                return;
+            }
+        }
+    }
+
+    // copies the first element to out and removes it; false if empty. The
+    // element is removed before it is copied: if the copy throws, it is lost.
+    bool try_pop_front(T& out) {
+        guard g(hazards);
+        for (;;) {
+            node* dummy = domain::protect(g.r, 0, head);
+            node* first = domain::protect(g.r, 1, dummy->next);
+            if (domain::is_marked(first)) {
+                head.compare_exchange_weak(dummy, domain::unmarked(first));
+                continue;
+            }
+            if (first == nullptr) {
+                return false;
+            }
+            node* last = tail.load();
+            if (last == dummy) {
+                // keep tail from pointing at the node about to be retired
+                tail.compare_exchange_weak(last, first);
+                continue;
+            }
+            if (!dummy->next.compare_exchange_weak(first,
+                                                   domain::marked(first))) {
+                continue;
+            }
+            // the element is ours now; first stays protected by slot 1, so
+            // it may become the dummy and be retired before the copy
+            node* expected = dummy;
+            head.compare_exchange_strong(expected, first);
+            hazards.retire(g.r, dummy);
+            out = first->value();
+            return true;
+        }
+    }
+
+    bool empty() const {
+        guard g(hazards);
+        node* dummy = domain::protect(g.r, 0, head);
+        return domain::unmarked(dummy->next.load()) == nullptr;
+    }
+
+    // Calls f on the elements front to back. Elements present during the
+    // whole call are visited exactly once; elements pushed or popped
+    // meanwhile may or may not be. When the node being left gets popped,
+    // the walk resumes at the current front: everything visited so far has
+    // been popped too, so nothing is visited twice.
+    template <typename F>
+    void for_each(F f) const {
+        guard g(hazards);
+        std::size_t slot = 0;
+        node* prev = domain::protect(g.r, slot, head);
+        for (;;) {
+            node* cur = domain::protect(g.r, 1 - slot, prev->next);
+            if (domain::is_marked(cur)) {
+                // prev is a dummy being popped: help move head past it
+                node* expected = prev;
+                head.compare_exchange_strong(expected, domain::unmarked(cur));
+                prev = domain::protect(g.r, slot, head);
+                continue;
+            }
+            if (cur == nullptr) {
+                return;
+            }
+            f(static_cast<T const&>(cur->value()));
+            prev = cur;
+            slot = 1 - slot;
+        }
+    }
+};
+
+}  // namespace my
+
+#endif  // MY_CONCURRENT_LIST
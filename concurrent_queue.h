@@ -0,0 +1,228 @@
+#ifndef MY_CONCURRENT_QUEUE
+#define MY_CONCURRENT_QUEUE
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace my {
+
+// Unbounded queue for exactly one producer and one consumer thread. Both
+// sides are wait-free (apart from the allocator): the producer only writes
+// tail, the consumer only writes head, and the two meet in one release /
+// acquire pair on the link of the newest node. head is a dummy node whose
+// value has already been taken.
+template <typename T>
+class spsc_queue {
+   private:
+    struct node {
+        std::atomic<node*> next{nullptr};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T& value() { return *reinterpret_cast<T*>(storage); }
+    };
+
+    alignas(64) node* head;
+    alignas(64) node* tail;
+
+    // next becomes the dummy once its value is used
+    void pop_taken(node* next) noexcept {
+        next->value().~T();
+        delete head;
+        head = next;
+    }
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    spsc_queue() : head(new node), tail(head) {}
+
+    spsc_queue(spsc_queue const&) = delete;
+    spsc_queue& operator=(spsc_queue const&) = delete;
+
+    ~spsc_queue() {
+        consume_all([](T&&) {});
+        delete head;
+    }
+
+    // producer side
+    void push(T const& value) { emplace(value); }
+    void push(T&& value) { emplace(std::move(value)); }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        node* n = new node;
+        try {
+            ::new (static_cast<void*>(n->storage))
+                T(std::forward<Args>(args)...);
+        } catch (...) {
+            delete n;
+            throw;
+        }
+        tail->next.store(n, std::memory_order_release);
+        tail = n;
+    }
+
+    // consumer side: moves the oldest element to out; false if empty
+    bool try_pop(T& out) {
+        node* next = head->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        out = std::move(next->value());
+        pop_taken(next);
+        return true;
+    }
+
+    // consumer side: hands the elements to f as rvalues, oldest first,
+    // until it finds the queue empty; returns how many there were
+    template <typename F>
+    size_type consume_all(F f) {
+        size_type n = 0;
+        node* next = head->next.load(std::memory_order_acquire);
+        while (next != nullptr) {
+            try {
+                f(std::move(next->value()));
+            } catch (...) {
+                pop_taken(next);
+                throw;
+            }
+            pop_taken(next);
+            next = head->next.load(std::memory_order_acquire);
+            n++;
+        }
+        return n;
+    }
+
+    // consumer side
+    bool empty() const {
+        return head->next.load(std::memory_order_acquire) == nullptr;
+    }
+};
+
+// Unbounded queue for many producers and one consumer. Producers push onto
+// a Treiber stack with one CAS each (lock-free); the consumer takes the
+// whole stack with a single exchange, reverses it into FIFO order and then
+// works through it without touching shared memory, which amortises the
+// synchronisation over every element of the batch. Elements of one
+// producer come out in the order it pushed them.
+template <typename T>
+class mpsc_queue {
+   private:
+    struct node {
+        node* next;
+        T value;
+
+        template <typename... Args>
+        explicit node(Args&&... args) : value(std::forward<Args>(args)...) {}
+    };
+
+    alignas(64) std::atomic<node*> pushed{nullptr};
+    // consumer owned: the rest of the last batch, oldest first
+    alignas(64) node* batch = nullptr;
+
+    static void destroy_chain(node* p) noexcept {
+        while (p != nullptr) {
+            node* next = p->next;
+            delete p;
+            p = next;
+        }
+    }
+
+    // takes everything pushed so far, oldest first
+    node* take_pushed() noexcept {
+        node* p = pushed.exchange(nullptr, std::memory_order_acquire);
+        node* fifo = nullptr;
+        while (p != nullptr) {
+            node* next = p->next;
+            p->next = fifo;
+            fifo = p;
+            p = next;
+        }
+        return fifo;
+    }
+
+    template <typename F>
+    std::size_t drain(F& f) {
+        std::size_t n = 0;
+        while (batch != nullptr) {
+            node* p = batch;
+            batch = p->next;
+            try {
+                f(std::move(p->value));
+            } catch (...) {
+                delete p;
+                throw;
+            }
+            delete p;
+            n++;
+        }
+        return n;
+    }
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    mpsc_queue() = default;
+
+    mpsc_queue(mpsc_queue const&) = delete;
+    mpsc_queue& operator=(mpsc_queue const&) = delete;
+
+    ~mpsc_queue() {
+        destroy_chain(batch);
+        destroy_chain(pushed.load(std::memory_order_acquire));
+    }
+
+    // producer side, any thread
+    void push(T const& value) { emplace(value); }
+    void push(T&& value) { emplace(std::move(value)); }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        node* n = new node(std::forward<Args>(args)...);
+        n->next = pushed.load(std::memory_order_relaxed);
+        while (!pushed.compare_exchange_weak(n->next, n,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+    }
+
+    // consumer side: moves the oldest element to out; false if empty. Takes
+    // a new batch only once the previous one is used up.
+    bool try_pop(T& out) {
+        if (batch == nullptr) {
+            batch = take_pushed();
+            if (batch == nullptr) {
+                return false;
+            }
+        }
+        node* p = batch;
+        out = std::move(p->value);
+        batch = p->next;
+        delete p;
+        return true;
+    }
+
+    // consumer side: hands the rest of the current batch and everything
+    // pushed so far to f as rvalues, oldest first, with one exchange on
+    // the shared head; returns how many elements there were
+    template <typename F>
+    size_type consume_all(F f) {
+        size_type n = drain(f);
+        batch = take_pushed();
+        return n + drain(f);
+    }
+
+    // consumer side
+    bool empty() const {
+        return batch == nullptr &&
+               pushed.load(std::memory_order_acquire) == nullptr;
+    }
+};
+
+}  // namespace my
+
+#endif  // MY_CONCURRENT_QUEUE
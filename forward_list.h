@@ -0,0 +1,390 @@
+#ifndef MY_FORWARD_LIST
+#define MY_FORWARD_LIST
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "node_pool.h"
+
+namespace my {
+
+// Singly linked list with a tail pointer, for queues that only push at the
+// back, pop at the front and walk forward: every operation writes one link
+// per node instead of two. Node storage (cache, slabs) works as in my::list.
+template <typename T, typename Alloc = std::allocator<T>>
+class forward_list {
+   private:
+    struct node_base {
+        node_base* next;
+    };
+
+    struct node : node_base {
+        T value;
+
+        template <typename... Args>
+        node(node_base* n, Args&&... args)
+            : node_base{n}, value(std::forward<Args>(args)...) {}
+    };
+
+    using node_allocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    // head is the node before the first one; tail is &head when empty
+    node_base head{nullptr};
+    node_base* tail = &head;
+    std::size_t count = 0;
+    node_allocator alloc;
+    detail::node_pool<node, node_allocator> pool;
+
+    static T& value_of(node_base* p) { return static_cast<node*>(p)->value; }
+
+    template <typename... Args>
+    node* create_node(node_base* next, Args&&... args) {
+        node* p = pool.take(alloc);
+        try {
+            node_traits::construct(alloc, p, next,
+                                   std::forward<Args>(args)...);
+        } catch (...) {
+            pool.give_back(alloc, p);
+            throw;
+        }
+        return p;
+    }
+
+    void destroy_node(node_base* p) {
+        node* n = static_cast<node*>(p);
+        node_traits::destroy(alloc, n);
+        pool.give_back(alloc, n);
+    }
+
+    template <typename U>
+    struct forward_iterator;
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+    using iterator = forward_iterator<T>;
+    using const_iterator = forward_iterator<T const>;
+
+    forward_list() noexcept(noexcept(node_allocator())) : alloc() {}
+
+    explicit forward_list(Alloc const& a) noexcept : alloc(a) {}
+
+    forward_list(std::initializer_list<T> init_list, Alloc const& a = Alloc())
+        : forward_list(a) {
+        for (auto const& x : init_list) {
+            push_back(x);
+        }
+    }
+
+    // inherits the storage policy of other
+    forward_list(forward_list const& other)
+        : alloc(node_traits::select_on_container_copy_construction(
+              other.alloc)) {
+        copy_storage_policy(other);
+        pool.reserve(alloc, other.count);
+        try {
+            for (auto const& x : other) {
+                push_back(x);
+            }
+        } catch (...) {
+            clear();
+            trim_node_cache();
+            throw;
+        }
+    }
+
+    forward_list(forward_list&& other) noexcept
+        : alloc(std::move(other.alloc)) {
+        swap_nodes(other);
+    }
+
+    // keeps the storage policy of this list
+    forward_list& operator=(forward_list const& other) {
+        if (this != &other) {
+            using propagate =
+                typename node_traits::propagate_on_container_copy_assignment;
+            forward_list tmp(Alloc(propagate::value ? other.alloc : alloc));
+            tmp.copy_storage_policy(*this);
+            for (auto const& x : other) {
+                tmp.push_back(x);
+            }
+            swap_nodes(tmp);
+            swap_allocator(tmp, propagate());
+        }
+        return *this;
+    }
+
+    forward_list& operator=(forward_list&& other) noexcept(
+        node_traits::propagate_on_container_move_assignment::value ||
+        node_traits::is_always_equal::value) {
+        if (this != &other) {
+            move_assign(
+                other,
+                std::integral_constant<
+                    bool,
+                    node_traits::propagate_on_container_move_assignment::value ||
+                        node_traits::is_always_equal::value>());
+        }
+        return *this;
+    }
+
+    ~forward_list() {
+        clear();
+        trim_node_cache();
+    }
+
+    allocator_type get_allocator() const { return Alloc(alloc); }
+
+    // see my::list::use_slab_storage
+    void use_slab_storage(size_type first_slab = 64) {
+        assert(empty());
+        clear();
+        trim_node_cache();
+        pool.use_slabs(first_slab);
+    }
+
+    bool uses_slab_storage() const noexcept { return pool.uses_slabs(); }
+
+    // see my::list::set_node_cache_limit
+    size_type node_cache_size() const noexcept { return pool.cached(); }
+    size_type node_cache_limit() const noexcept { return pool.limit(); }
+
+    void set_node_cache_limit(size_type limit) {
+        pool.set_limit(limit);
+        if (pool.cached() > limit) {
+            trim_node_cache(limit);
+        }
+    }
+
+    void trim_node_cache(size_type keep = 0) { pool.trim(alloc, keep); }
+
+   private:
+    template <typename U>
+    struct forward_iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename std::remove_const<U>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        friend class forward_list;
+        forward_iterator() = default;
+        forward_iterator(forward_iterator<T> const& other) : ptr(other.ptr) {}
+
+        forward_iterator& operator++() {
+            ptr = ptr->next;
+            return *this;
+        }
+        forward_iterator operator++(int) {
+            forward_iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        U& operator*() const { return value_of(ptr); }
+        U* operator->() const { return &value_of(ptr); }
+
+        template <typename Z>
+        bool operator==(forward_iterator<Z> const& other) const {
+            return ptr == other.ptr;
+        }
+        template <typename Z>
+        bool operator!=(forward_iterator<Z> const& other) const {
+            return ptr != other.ptr;
+        }
+
+       private:
+        forward_iterator(node_base* p) : ptr(p) {}
+        node_base* ptr = nullptr;
+
+        template <typename Z>
+        friend struct forward_iterator;
+    };
+
+   public:
+    iterator before_begin() { return iterator(&head); }
+    const_iterator before_begin() const {
+        return const_iterator(const_cast<node_base*>(&head));
+    }
+    iterator begin() { return iterator(head.next); }
+    const_iterator begin() const { return const_iterator(head.next); }
+    iterator end() { return iterator(nullptr); }
+    const_iterator end() const { return const_iterator(nullptr); }
+
+    const_iterator cbefore_begin() const { return before_begin(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool empty() const { return head.next == nullptr; }
+    size_type size() const noexcept { return count; }
+
+    T& front() {
+        assert(!empty());
+        return value_of(head.next);
+    }
+    T const& front() const {
+        assert(!empty());
+        return value_of(head.next);
+    }
+    T& back() {
+        assert(!empty());
+        return value_of(tail);
+    }
+    T const& back() const {
+        assert(!empty());
+        return value_of(tail);
+    }
+
+    void push_back(T const& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        node* p = create_node(nullptr, std::forward<Args>(args)...);
+        tail->next = p;
+        tail = p;
+        count++;
+        return p->value;
+    }
+
+    void push_front(T const& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args) {
+        return *emplace_after(before_begin(), std::forward<Args>(args)...);
+    }
+
+    void pop_front() {
+        assert(!empty());
+        erase_after(before_begin());
+    }
+
+    iterator insert_after(const_iterator pos, T const& value) {
+        return emplace_after(pos, value);
+    }
+    iterator insert_after(const_iterator pos, T&& value) {
+        return emplace_after(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator emplace_after(const_iterator pos, Args&&... args) {
+        node* p = create_node(pos.ptr->next, std::forward<Args>(args)...);
+        pos.ptr->next = p;
+        if (tail == pos.ptr) {
+            tail = p;
+        }
+        count++;
+        return iterator(p);
+    }
+
+    iterator erase_after(const_iterator pos) {
+        assert(pos.ptr->next != nullptr);
+        node_base* to_del = pos.ptr->next;
+        pos.ptr->next = to_del->next;
+        if (tail == to_del) {
+            tail = pos.ptr;
+        }
+        count--;
+        destroy_node(to_del);
+        return iterator(pos.ptr->next);
+    }
+
+    void clear() {
+        node_base* cur = head.next;
+        if (pool.uses_slabs()) {
+            if (!std::is_trivially_destructible<T>::value) {
+                for (; cur != nullptr; cur = cur->next) {
+                    node_traits::destroy(alloc, static_cast<node*>(cur));
+                }
+            }
+            pool.release_slabs(alloc);
+        } else {
+            while (cur != nullptr) {
+                node_base* to_del = cur;
+                cur = cur->next;
+                destroy_node(to_del);
+            }
+        }
+        head.next = nullptr;
+        tail = &head;
+        count = 0;
+    }
+
+    template <typename U, typename A>
+    friend void swap(forward_list<U, A>& a, forward_list<U, A>& b) noexcept;
+
+   private:
+    void swap_nodes(forward_list& other) noexcept {
+        std::swap(head.next, other.head.next);
+        std::swap(tail, other.tail);
+        if (tail == &other.head) {
+            tail = &head;
+        }
+        if (other.tail == &head) {
+            other.tail = &other.head;
+        }
+        std::swap(count, other.count);
+        pool.swap(other.pool);
+    }
+
+    void swap_allocator(forward_list& other, std::true_type) noexcept {
+        using std::swap;
+        swap(alloc, other.alloc);
+    }
+    void swap_allocator(forward_list&, std::false_type) noexcept {}
+
+    void move_allocator(forward_list& other, std::true_type) noexcept {
+        alloc = std::move(other.alloc);
+    }
+    void move_allocator(forward_list&, std::false_type) noexcept {}
+
+    // the nodes of other can be adopted as they are
+    void move_assign(forward_list& other, std::true_type) noexcept {
+        clear();
+        trim_node_cache();
+        swap_nodes(other);
+        move_allocator(
+            other,
+            typename node_traits::propagate_on_container_move_assignment());
+    }
+
+    void move_assign(forward_list& other, std::false_type) {
+        if (alloc == other.alloc) {
+            move_assign(other, std::true_type());
+            return;
+        }
+        clear();
+        for (auto& x : other) {
+            push_back(std::move(x));
+        }
+        other.clear();
+    }
+
+    // makes an empty list store its nodes the way other does
+    void copy_storage_policy(forward_list const& other) {
+        pool.set_limit(other.pool.limit());
+        if (other.pool.uses_slabs()) {
+            pool.use_slabs(other.pool.first_slab());
+        }
+    }
+};
+
+template <typename U, typename A>
+void swap(forward_list<U, A>& a, forward_list<U, A>& b) noexcept {
+    using traits = typename forward_list<U, A>::node_traits;
+    a.swap_nodes(b);
+    a.swap_allocator(b, typename traits::propagate_on_container_swap());
+}
+
+}  // namespace my
+
+#endif  // MY_FORWARD_LIST
@@ -0,0 +1,548 @@
+#ifndef MY_INDEX_LIST
+#define MY_INDEX_LIST
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace my {
+
+// Doubly linked list whose nodes live in one contiguous buffer and link to
+// each other by 32-bit slot indices. Slot 0 is the sentinel, erased slots
+// are chained into a free list and reused first. Because links are
+// indices, the buffer of a trivially copyable T can be copied or written
+// out byte for byte. Iterators hold the list and an index, so they stay
+// valid when the buffer grows.
+template <typename T, typename Alloc = std::allocator<T>>
+class index_list {
+   public:
+    using index_type = std::uint32_t;
+
+   private:
+    struct slot {
+        index_type next;
+        index_type prev;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    using slot_allocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<slot>;
+    using slot_traits = std::allocator_traits<slot_allocator>;
+
+    // an unallocated list points at a shared, never written sentinel
+    static slot* empty_buffer() {
+        static slot sentinel{0, 0, {}};
+        return &sentinel;
+    }
+
+    slot* slots = empty_buffer();
+    index_type cap = 0;
+    index_type used = 0;
+    index_type free_head = 0;
+    std::size_t count = 0;
+    slot_allocator alloc;
+
+    T* value_ptr(index_type i) const {
+        return reinterpret_cast<T*>(slots[i].storage);
+    }
+
+    template <typename U>
+    struct index_iterator;
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+    using iterator = index_iterator<T>;
+    using const_iterator = index_iterator<T const>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    index_list() noexcept(noexcept(slot_allocator())) : alloc() {}
+
+    explicit index_list(Alloc const& a) noexcept : alloc(a) {}
+
+    index_list(std::initializer_list<T> init_list, Alloc const& a = Alloc())
+        : index_list(a) {
+        reserve(init_list.size());
+        for (auto const& x : init_list) {
+            push_back(x);
+        }
+    }
+
+    index_list(index_list const& other)
+        : alloc(slot_traits::select_on_container_copy_construction(
+              other.alloc)) {
+        copy_from(other);
+    }
+
+    index_list(index_list&& other) noexcept : alloc(std::move(other.alloc)) {
+        steal(other);
+    }
+
+    index_list& operator=(index_list const& other) {
+        if (this != &other) {
+            using propagate =
+                typename slot_traits::propagate_on_container_copy_assignment;
+            index_list tmp(Alloc(propagate::value ? other.alloc : alloc));
+            tmp.copy_from(other);
+            swap_buffers(tmp);
+            swap_allocator(tmp, propagate());
+        }
+        return *this;
+    }
+
+    index_list& operator=(index_list&& other) noexcept(
+        slot_traits::propagate_on_container_move_assignment::value ||
+        slot_traits::is_always_equal::value) {
+        if (this != &other) {
+            move_assign(
+                other,
+                std::integral_constant<
+                    bool,
+                    slot_traits::propagate_on_container_move_assignment::value ||
+                        slot_traits::is_always_equal::value>());
+        }
+        return *this;
+    }
+
+    ~index_list() { release(); }
+
+    allocator_type get_allocator() const { return Alloc(alloc); }
+
+   private:
+    template <typename U>
+    struct index_iterator {
+       public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename std::remove_const<U>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        friend class index_list;
+        index_iterator() = default;
+        index_iterator(index_iterator<T> const& other)
+            : owner(other.owner), index(other.index) {}
+
+        index_iterator& operator++() {
+            index = owner->slots[index].next;
+            return *this;
+        }
+        index_iterator operator++(int) {
+            index_iterator old(*this);
+            ++*this;
+            return old;
+        }
+        index_iterator& operator--() {
+            index = owner->slots[index].prev;
+            return *this;
+        }
+        index_iterator operator--(int) {
+            index_iterator old(*this);
+            --*this;
+            return old;
+        }
+
+        U& operator*() const { return *owner->value_ptr(index); }
+        U* operator->() const { return owner->value_ptr(index); }
+
+        template <typename Z>
+        bool operator==(index_iterator<Z> const& other) const {
+            return index == other.index;
+        }
+        template <typename Z>
+        bool operator!=(index_iterator<Z> const& other) const {
+            return index != other.index;
+        }
+
+       private:
+        index_iterator(index_list const* o, index_type i)
+            : owner(o), index(i) {}
+
+        index_list const* owner = nullptr;
+        index_type index = 0;
+
+        template <typename Z>
+        friend struct index_iterator;
+    };
+
+   public:
+    iterator begin() { return iterator(this, slots[0].next); }
+    const_iterator begin() const { return const_iterator(this, slots[0].next); }
+    iterator end() { return iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, 0); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const { return count == 0; }
+    size_type size() const noexcept { return count; }
+
+    // slots available without growing the buffer, not counting the sentinel
+    size_type capacity() const noexcept { return cap == 0 ? 0 : cap - 1; }
+
+    void reserve(size_type n) {
+        if (n + 1 > cap) {
+            grow(n + 1);
+        }
+    }
+
+    // the whole buffer, sentinel first; self-contained when T is trivially
+    // copyable
+    void const* data() const noexcept { return slots; }
+    size_type data_size() const noexcept { return used * sizeof(slot); }
+
+    // Replaces the contents by size bytes written out from data() of an
+    // index_list of the same T, e.g. read back from a file. The free list
+    // is rebuilt from the slots the links do not reach. Throws
+    // std::invalid_argument if the bytes do not hold a well-formed list.
+    void assign_bytes(void const* bytes, size_type size) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "only a trivially copyable T is stored byte for byte");
+        const size_type max_cap = static_cast<index_type>(-1);
+        if (size == 0) {
+            clear();
+            return;
+        }
+        if (size % sizeof(slot) != 0 || size / sizeof(slot) > max_cap) {
+            throw std::invalid_argument("index_list: not a slot buffer");
+        }
+        size_type new_used = size / sizeof(slot);
+        std::vector<bool> linked(new_used, false);
+        slot* fresh = slot_traits::allocate(alloc, new_used);
+        std::memcpy(static_cast<void*>(fresh), bytes, size);
+
+        // every linked slot is reached once, with a matching back link
+        size_type new_count = 0;
+        index_type prev = 0;
+        index_type i = fresh[0].next;
+        for (; i != 0; prev = i, i = fresh[i].next) {
+            if (i >= new_used || linked[i] || fresh[i].prev != prev) {
+                break;
+            }
+            linked[i] = true;
+            new_count++;
+        }
+        if (i != 0 || fresh[0].prev != prev) {
+            slot_traits::deallocate(alloc, fresh, new_used);
+            throw std::invalid_argument("index_list: malformed links");
+        }
+
+        index_type new_free = 0;
+        for (index_type j = static_cast<index_type>(new_used - 1); j > 0;
+             j--) {
+            if (!linked[j]) {
+                fresh[j].next = new_free;
+                new_free = j;
+            }
+        }
+        release();
+        slots = fresh;
+        cap = used = static_cast<index_type>(new_used);
+        free_head = new_free;
+        count = new_count;
+    }
+
+    T& front() {
+        assert(!empty());
+        return *value_ptr(slots[0].next);
+    }
+    T const& front() const {
+        assert(!empty());
+        return *value_ptr(slots[0].next);
+    }
+    T& back() {
+        assert(!empty());
+        return *value_ptr(slots[0].prev);
+    }
+    T const& back() const {
+        assert(!empty());
+        return *value_ptr(slots[0].prev);
+    }
+
+    void push_back(T const& value) { emplace(end(), value); }
+    void push_back(T&& value) { emplace(end(), std::move(value)); }
+    void push_front(T const& value) { emplace(begin(), value); }
+    void push_front(T&& value) { emplace(begin(), std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        return *emplace(end(), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args) {
+        return *emplace(begin(), std::forward<Args>(args)...);
+    }
+
+    void pop_back() {
+        assert(!empty());
+        erase(const_iterator(this, slots[0].prev));
+    }
+    void pop_front() {
+        assert(!empty());
+        erase(const_iterator(this, slots[0].next));
+    }
+
+    iterator insert(const_iterator pos, T const& value) {
+        return emplace(pos, value);
+    }
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        if (free_head == 0 && used == cap) {
+            // the arguments may refer to elements that growing would move
+            T tmp(std::forward<Args>(args)...);
+            expand();
+            return emplace(pos, std::move(tmp));
+        }
+        index_type i = take_slot();
+        try {
+            slot_traits::construct(alloc, value_ptr(i),
+                                   std::forward<Args>(args)...);
+        } catch (...) {
+            release_slot(i);
+            throw;
+        }
+        index_type next = pos.index;
+        index_type prev = slots[next].prev;
+        slots[i].next = next;
+        slots[i].prev = prev;
+        slots[prev].next = i;
+        slots[next].prev = i;
+        count++;
+        return iterator(this, i);
+    }
+
+    iterator erase(const_iterator pos) {
+        assert(!empty() && pos.index != 0);
+        index_type i = pos.index;
+        index_type next = slots[i].next;
+        slots[slots[i].prev].next = next;
+        slots[next].prev = slots[i].prev;
+        slot_traits::destroy(alloc, value_ptr(i));
+        release_slot(i);
+        count--;
+        return iterator(this, next);
+    }
+
+    void clear() {
+        destroy_values();
+        reset();
+    }
+
+    template <typename U, typename A>
+    friend void swap(index_list<U, A>& a, index_list<U, A>& b) noexcept;
+
+   private:
+    // every slot below used is either linked or on the free list
+    index_type take_slot() {
+        if (free_head != 0) {
+            index_type i = free_head;
+            free_head = slots[i].next;
+            return i;
+        }
+        if (used == cap) {
+            expand();
+        }
+        return used++;
+    }
+
+    void expand() { grow(cap < 8 ? 16 : 2 * static_cast<size_type>(cap)); }
+
+    void release_slot(index_type i) {
+        slots[i].next = free_head;
+        free_head = i;
+    }
+
+    void grow(size_type new_cap) {
+        const size_type max_cap = static_cast<index_type>(-1);
+        if (cap == max_cap) {
+            throw std::length_error("index_list: out of 32-bit indices");
+        }
+        if (new_cap > max_cap) {
+            new_cap = max_cap;
+        }
+        slot* fresh = slot_traits::allocate(alloc, new_cap);
+        if (cap == 0) {
+            fresh[0].next = fresh[0].prev = 0;
+            used = 1;
+        } else {
+            try {
+                relocate(fresh);
+            } catch (...) {
+                slot_traits::deallocate(alloc, fresh, new_cap);
+                throw;
+            }
+            slot_traits::deallocate(alloc, slots, cap);
+        }
+        slots = fresh;
+        cap = static_cast<index_type>(new_cap);
+    }
+
+    // Copies the links of all used slots and moves the live values. If a
+    // copy throws (a move is only used when it cannot), the values placed
+    // in fresh are destroyed again and the list keeps its old buffer.
+    void relocate(slot* fresh) {
+        if (std::is_trivially_copyable<T>::value) {
+            std::memcpy(static_cast<void*>(fresh), slots, used * sizeof(slot));
+            return;
+        }
+        for (index_type i = 0; i < used; i++) {
+            fresh[i].next = slots[i].next;
+            fresh[i].prev = slots[i].prev;
+        }
+        index_type i = slots[0].next;
+        try {
+            for (; i != 0; i = slots[i].next) {
+                slot_traits::construct(alloc,
+                                       reinterpret_cast<T*>(fresh[i].storage),
+                                       std::move_if_noexcept(*value_ptr(i)));
+            }
+        } catch (...) {
+            for (index_type j = slots[0].next; j != i; j = slots[j].next) {
+                slot_traits::destroy(alloc,
+                                     reinterpret_cast<T*>(fresh[j].storage));
+            }
+            throw;
+        }
+        destroy_values();
+    }
+
+    void destroy_values() {
+        if (!std::is_trivially_destructible<T>::value) {
+            for (index_type i = slots[0].next; i != 0; i = slots[i].next) {
+                slot_traits::destroy(alloc, value_ptr(i));
+            }
+        }
+    }
+
+    void reset() {
+        if (cap != 0) {
+            slots[0].next = slots[0].prev = 0;
+            used = 1;
+        }
+        free_head = 0;
+        count = 0;
+    }
+
+    void release() {
+        if (cap != 0) {
+            destroy_values();
+            slot_traits::deallocate(alloc, slots, cap);
+            slots = empty_buffer();
+            cap = used = free_head = 0;
+            count = 0;
+        }
+    }
+
+    void swap_buffers(index_list& other) noexcept {
+        using std::swap;
+        swap(slots, other.slots);
+        swap(cap, other.cap);
+        swap(used, other.used);
+        swap(free_head, other.free_head);
+        swap(count, other.count);
+    }
+
+    void swap_allocator(index_list& other, std::true_type) noexcept {
+        using std::swap;
+        swap(alloc, other.alloc);
+    }
+    void swap_allocator(index_list&, std::false_type) noexcept {}
+
+    void move_allocator(index_list& other, std::true_type) noexcept {
+        alloc = std::move(other.alloc);
+    }
+    void move_allocator(index_list&, std::false_type) noexcept {}
+
+    // the buffer of other can be adopted as it is
+    void move_assign(index_list& other, std::true_type) noexcept {
+        release();
+        move_allocator(
+            other,
+            typename slot_traits::propagate_on_container_move_assignment());
+        steal(other);
+    }
+
+    void move_assign(index_list& other, std::false_type) {
+        if (alloc == other.alloc) {
+            move_assign(other, std::true_type());
+            return;
+        }
+        clear();
+        reserve(other.size());
+        for (auto& x : other) {
+            push_back(std::move(x));
+        }
+        other.clear();
+    }
+
+    void steal(index_list& other) noexcept {
+        slots = other.slots;
+        cap = other.cap;
+        used = other.used;
+        free_head = other.free_head;
+        count = other.count;
+        other.slots = empty_buffer();
+        other.cap = other.used = other.free_head = 0;
+        other.count = 0;
+    }
+
+    void copy_from(index_list const& other) {
+        if (other.cap == 0) {
+            return;
+        }
+        slots = slot_traits::allocate(alloc, other.cap);
+        cap = other.cap;
+        if (std::is_trivially_copyable<T>::value) {
+            std::memcpy(static_cast<void*>(slots), other.slots,
+                        other.used * sizeof(slot));
+            used = other.used;
+            free_head = other.free_head;
+            count = other.count;
+            return;
+        }
+        reset();
+        try {
+            for (auto const& x : other) {
+                push_back(x);
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+};
+
+template <typename U, typename A>
+void swap(index_list<U, A>& a, index_list<U, A>& b) noexcept {
+    using traits = typename index_list<U, A>::slot_traits;
+    a.swap_buffers(b);
+    a.swap_allocator(b, typename traits::propagate_on_container_swap());
+}
+
+}  // namespace my
+
+#endif  // MY_INDEX_LIST
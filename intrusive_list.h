@@ -0,0 +1,339 @@
+#ifndef MY_INTRUSIVE_LIST
+#define MY_INTRUSIVE_LIST
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+// Links embedded into the user's objects. Copying an object does not copy
+// its membership, so the copy starts unlinked. The tag lets one object
+// carry several hooks and sit in several lists at once.
+template <typename Tag = void>
+struct list_hook {
+    list_hook* next = nullptr;
+    list_hook* prev = nullptr;
+
+    list_hook() = default;
+    list_hook(list_hook const&) noexcept {}
+    list_hook& operator=(list_hook const&) noexcept { return *this; }
+
+    bool is_linked() const noexcept { return next != nullptr; }
+};
+
+// T derives from list_hook<Tag>
+template <typename T, typename Tag = void>
+struct base_hook {
+    using hook_type = list_hook<Tag>;
+
+    static hook_type* to_hook(T& value) { return &value; }
+    static T* to_value(hook_type* hook) { return static_cast<T*>(hook); }
+};
+
+// The hook is the data member Member of T. Its offset within T is taken
+// from the first object passed to to_hook: a hook only reaches to_value
+// after its object went through to_hook, and no T has to be conjured up
+// (offsetof would need a member name and a standard-layout T).
+template <typename T, typename Hook, Hook T::*Member>
+struct member_hook {
+    using hook_type = Hook;
+
+    static hook_type* to_hook(T& value) {
+        offset(&value);
+        return &(value.*Member);
+    }
+    static T* to_value(hook_type* hook) {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - offset());
+    }
+
+   private:
+    static std::ptrdiff_t offset(T const* value = nullptr) {
+        static const std::ptrdiff_t bytes = measure(value);
+        return bytes;
+    }
+
+    static std::ptrdiff_t measure(T const* value) {
+        assert(value != nullptr);
+        return reinterpret_cast<char const*>(&(value->*Member)) -
+               reinterpret_cast<char const*>(value);
+    }
+};
+
+// List over objects that live elsewhere: it never allocates, copies or
+// destroys an element, it only rewrites the hooks. Objects must stay alive
+// while linked; the list unlinks whatever is left in its destructor.
+template <typename T, typename HookTraits = base_hook<T>>
+class intrusive_list {
+   private:
+    using hook = typename HookTraits::hook_type;
+
+    hook loop;
+    std::size_t count = 0;
+
+    static T& value_of(hook* p) { return *HookTraits::to_value(p); }
+
+    template <typename U>
+    struct list_iterator;
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = list_iterator<T>;
+    using const_iterator = list_iterator<T const>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    intrusive_list() noexcept { loop.next = loop.prev = &loop; }
+
+    intrusive_list(intrusive_list const&) = delete;
+    intrusive_list& operator=(intrusive_list const&) = delete;
+
+    intrusive_list(intrusive_list&& other) noexcept : intrusive_list() {
+        swap(*this, other);
+    }
+
+    intrusive_list& operator=(intrusive_list&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(*this, other);
+        }
+        return *this;
+    }
+
+    ~intrusive_list() { clear(); }
+
+   private:
+    template <typename U>
+    struct list_iterator {
+       public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename std::remove_const<U>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        friend class intrusive_list;
+        list_iterator() = default;
+        list_iterator(list_iterator<T> const& other) : ptr(other.ptr) {}
+        list_iterator& operator++() {
+            ptr = ptr->next;
+            return *this;
+        }
+        list_iterator operator++(int) {
+            list_iterator old(*this);
+            ++*this;
+            return old;
+        }
+        list_iterator& operator--() {
+            ptr = ptr->prev;
+            return *this;
+        }
+        list_iterator operator--(int) {
+            list_iterator old(*this);
+            --*this;
+            return old;
+        }
+        U& operator*() const { return value_of(ptr); }
+
+        U* operator->() const { return &value_of(ptr); }
+
+        template <typename Z>
+        bool operator==(list_iterator<Z> const& other) const {
+            return ptr == other.ptr;
+        }
+        template <typename Z>
+        bool operator!=(list_iterator<Z> const& other) const {
+            return ptr != other.ptr;
+        }
+
+       private:
+        list_iterator(hook* p) : ptr(p) {}
+        hook* ptr = nullptr;
+
+        template <typename Z>
+        friend struct list_iterator;
+    };
+
+   public:
+    iterator begin() { return iterator(loop.next); }
+    const_iterator begin() const { return const_iterator(loop.next); }
+
+    iterator end() { return iterator(&loop); }
+    const_iterator end() const {
+        return const_iterator(const_cast<hook*>(&loop));
+    }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    // O(1): the iterator of an object known to be in this list
+    iterator iterator_to(T& value) {
+        return iterator(HookTraits::to_hook(value));
+    }
+    const_iterator iterator_to(T const& value) const {
+        return const_iterator(HookTraits::to_hook(const_cast<T&>(value)));
+    }
+
+    bool empty() const { return &loop == loop.next; }
+    size_type size() const noexcept { return count; }
+
+    T& front() {
+        assert(!empty());
+        return value_of(loop.next);
+    }
+    T const& front() const {
+        assert(!empty());
+        return value_of(loop.next);
+    }
+    T& back() {
+        assert(!empty());
+        return value_of(loop.prev);
+    }
+    T const& back() const {
+        assert(!empty());
+        return value_of(loop.prev);
+    }
+
+    void push_back(T& value) { insert(end(), value); }
+    void push_front(T& value) { insert(begin(), value); }
+
+    void pop_back() {
+        assert(!empty());
+        erase(const_iterator(loop.prev));
+    }
+    void pop_front() {
+        assert(!empty());
+        erase(const_iterator(loop.next));
+    }
+
+    iterator insert(const_iterator pos, T& value) {
+        hook* h = HookTraits::to_hook(value);
+        assert(!h->is_linked());
+        h->next = pos.ptr;
+        h->prev = pos.ptr->prev;
+        pos.ptr->prev->next = h;
+        pos.ptr->prev = h;
+        count++;
+        return iterator(h);
+    }
+
+    iterator erase(const_iterator pos) {
+        assert(pos.ptr != &loop);
+        hook* next = pos.ptr->next;
+        unlink_hook(pos.ptr);
+        count--;
+        return iterator(next);
+    }
+
+    iterator erase(const_iterator begin, const_iterator end) {
+        while (begin != end) {
+            begin = erase(begin);
+        }
+        return iterator(end.ptr);
+    }
+
+    // takes an object out of this list in O(1)
+    void unlink(T& value) { erase(iterator_to(value)); }
+
+    void clear() noexcept {
+        hook* cur = loop.next;
+        while (cur != &loop) {
+            hook* next = cur->next;
+            cur->next = cur->prev = nullptr;
+            cur = next;
+        }
+        loop.next = loop.prev = &loop;
+        count = 0;
+    }
+
+    void splice(const_iterator pos, intrusive_list& other) {
+        splice(pos, other, other.begin(), other.end(), other.count);
+    }
+
+    void splice(const_iterator pos, intrusive_list& other, const_iterator it) {
+        const_iterator next = it;
+        ++next;
+        if (pos != it) {
+            splice(pos, other, it, next, 1);
+        }
+    }
+
+    void splice(const_iterator pos, intrusive_list& other,
+                const_iterator begin, const_iterator end) {
+        size_type n = 0;
+        if (&other != this) {
+            for (auto it = begin; it != end; ++it) {
+                n++;
+            }
+        }
+        splice(pos, other, begin, end, n);
+    }
+
+    // n must be std::distance(begin, end); makes the splice O(1)
+    void splice(const_iterator pos, intrusive_list& other,
+                const_iterator begin, const_iterator end, size_type n) {
+        if (begin == end || pos == end) {
+            return;
+        }
+        if (&other != this) {
+            other.count -= n;
+            count += n;
+        }
+        hook* to_con_left = begin.ptr->prev;
+
+        pos.ptr->prev->next = begin.ptr;
+        begin.ptr->prev = pos.ptr->prev;
+
+        end.ptr->prev->next = pos.ptr;
+        pos.ptr->prev = end.ptr->prev;
+
+        end.ptr->prev = to_con_left;
+        to_con_left->next = end.ptr;
+    }
+
+    template <typename U, typename H>
+    friend void swap(intrusive_list<U, H>& a,
+                     intrusive_list<U, H>& b) noexcept;
+
+   private:
+    static void unlink_hook(hook* h) noexcept {
+        h->prev->next = h->next;
+        h->next->prev = h->prev;
+        h->next = h->prev = nullptr;
+    }
+};
+
+template <typename U, typename H>
+void swap(intrusive_list<U, H>& a, intrusive_list<U, H>& b) noexcept {
+    auto a_left = a.loop.prev;
+    auto a_right = a.loop.next;
+
+    auto b_left = b.loop.prev;
+    auto b_right = b.loop.next;
+
+    a_left->next = &b.loop;
+    a_right->prev = &b.loop;
+
+    b_left->next = &a.loop;
+    b_right->prev = &a.loop;
+
+    std::swap(a.loop.next, b.loop.next);
+    std::swap(a.loop.prev, b.loop.prev);
+    std::swap(a.count, b.count);
+}
+
+}  // namespace my
+
+#endif  // MY_INTRUSIVE_LIST
@@ -2,58 +2,210 @@
 #define MY_LIST
 
 #include <cassert>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <memory>
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "node_pool.h"
 
 namespace my {
 
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T>>
 class list {
    private:
+    template <typename It>
+    using require_input_iterator = typename std::enable_if<std::is_convertible<
+        typename std::iterator_traits<It>::iterator_category,
+        std::input_iterator_tag>::value>::type;
+
     struct node_base {
         node_base* next;
         node_base* prev;
         node_base() : next(nullptr), prev(nullptr) {}
         node_base(node_base* p, node_base* n) : next(n), prev(p) {}
-        virtual ~node_base() = default;
     };
 
     struct node : node_base {
         T value;
 
         node() = delete;
-        node(T v) : node_base(), value(v) {}
-        node(T v, node_base* p) : node_base(p), value(v) {}
-        node(T v, node_base* p, node_base* n) : node_base(p, n), value(v) {}
+        template <typename... Args>
+        node(node_base* p, node_base* n, Args&&... args)
+            : node_base(p, n), value(std::forward<Args>(args)...) {}
     };
 
+    using node_allocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
     node_base loop;
+    std::size_t count = 0;
+    node_allocator alloc;
 
-   public:
-    list() noexcept { loop.next = loop.prev = &loop; }
+    detail::node_pool<node, node_allocator> pool;
 
-    list(list<T> const& other) : list() {
-        if (&other.loop != nullptr) {
-            node_base* cur = other.loop.next;
-            while (cur != &other.loop) {
-                push_back(static_cast<node*>(cur)->value);
-                cur = cur->next;
-            }
+    node* take_storage() { return pool.take(alloc); }
+
+    void release_storage(node* p) { pool.give_back(alloc, p); }
+
+    // lets the next n node creations share a single allocation when the
+    // list uses slab storage
+    void reserve_storage(std::size_t n) { pool.reserve(alloc, n); }
+
+    template <typename... Args>
+    node* create_node(Args&&... args) {
+        node* p = take_storage();
+        try {
+            node_traits::construct(alloc, p, std::forward<Args>(args)...);
+        } catch (...) {
+            release_storage(p);
+            throw;
         }
+        return p;
+    }
+
+    void destroy_node(node_base* p) {
+        node* n = static_cast<node*>(p);
+        node_traits::destroy(alloc, n);
+        release_storage(n);
+    }
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+
+    list() noexcept(noexcept(node_allocator())) : alloc() {
+        loop.next = loop.prev = &loop;
+    }
+
+    explicit list(Alloc const& a) noexcept : alloc(a) {
+        loop.next = loop.prev = &loop;
+    }
+
+    list(list const& other)
+        : list(Alloc(
+              node_traits::select_on_container_copy_construction(other.alloc))) {
+        copy_storage_policy(other);
+        append_copy(other);
+    }
+
+    list(list const& other, Alloc const& a) : list(a) {
+        copy_storage_policy(other);
+        append_copy(other);
+    }
+
+    list(list&& other) noexcept : alloc(std::move(other.alloc)) {
+        loop.next = loop.prev = &loop;
+        swap_nodes(other);
+    }
+
+    list(std::initializer_list<T> init_list, Alloc const& a = Alloc())
+        : list(a) {
+        insert(end(), init_list.begin(), init_list.end());
     }
 
-    list(std::initializer_list<T> init_list) : list() {
-        for (auto x : init_list) {
-            push_back(x);
+    template <typename InputIt, typename = require_input_iterator<InputIt>>
+    list(InputIt first, InputIt last, Alloc const& a = Alloc()) : list(a) {
+        insert(end(), first, last);
+    }
+
+    list(size_type n, T const& value, Alloc const& a = Alloc()) : list(a) {
+        insert(end(), n, value);
+    }
+
+    // Reuses the existing nodes by assigning over their values; only the
+    // length difference is allocated or freed.
+    list& operator=(list const& other) {
+        if (this == &other) {
+            return *this;
+        }
+        using propagate =
+            typename node_traits::propagate_on_container_copy_assignment;
+        if (propagate::value && alloc != other.alloc) {
+            // our nodes cannot outlive our allocator
+            list tmp(Alloc(other.alloc));
+            tmp.copy_storage_policy(*this);
+            tmp.append_copy(other);
+            swap_nodes(tmp);
+            swap_allocator(tmp, propagate());
+            return *this;
         }
+        copy_allocator(other, propagate());
+        node_base* cur = loop.next;
+        node_base* src = other.loop.next;
+        for (; cur != &loop && src != &other.loop;
+             cur = cur->next, src = src->next) {
+            value_of(cur) = value_of(src);
+        }
+        if (src == &other.loop) {
+            erase(const_iterator(cur), end());
+        } else {
+            insert(end(), const_iterator(src), other.end());
+        }
+        return *this;
     }
 
-    list<T>& operator=(list<T> const& other) {
-        list<T> tmp(other);
-        swap(tmp, *this);
+    list& operator=(list&& other) noexcept(
+        node_traits::propagate_on_container_move_assignment::value ||
+        node_traits::is_always_equal::value) {
+        if (this != &other) {
+            move_assign(
+                other,
+                std::integral_constant<
+                    bool,
+                    node_traits::propagate_on_container_move_assignment::value ||
+                        node_traits::is_always_equal::value>());
+        }
         return *this;
     }
 
-    ~list() { clear(); }
+    ~list() {
+        clear();
+        trim_node_cache();
+    }
+
+    allocator_type get_allocator() const { return Alloc(alloc); }
+
+    // Slab storage: nodes are carved out of contiguous slabs owned by the
+    // list (the first one holding first_slab nodes, at least 2 as one slot
+    // holds the slab header, each next one twice as large). Erased nodes
+    // are reused by later insertions; memory goes back to the allocator
+    // only in clear() and the destructor, one slab at a time. Must be
+    // enabled while the list is empty.
+    void use_slab_storage(size_type first_slab = 64) {
+        assert(empty());
+        clear();
+        trim_node_cache();
+        pool.use_slabs(first_slab);
+    }
+
+    bool uses_slab_storage() const noexcept { return pool.uses_slabs(); }
+
+    // Node cache: when the limit is non-zero, erased nodes are kept (up to
+    // the limit) and reused by later insertions instead of hitting the
+    // allocator. Disabled by default.
+    size_type node_cache_size() const noexcept { return pool.cached(); }
+    size_type node_cache_limit() const noexcept { return pool.limit(); }
+
+    void set_node_cache_limit(size_type limit) {
+        pool.set_limit(limit);
+        if (pool.cached() > limit) {
+            trim_node_cache(limit);
+        }
+    }
+
+    void trim_node_cache(size_type keep = 0) { pool.trim(alloc, keep); }
 
    private:
     template <typename U>
@@ -68,10 +220,15 @@ class list {
 
    private:
     template <typename U>
-    struct list_iterator
-        : public std::iterator<std::bidirectional_iterator_tag, U> {
+    struct list_iterator {
        public:
-        friend class list<T>;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename std::remove_const<U>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        friend class list;
         list_iterator() = default;
         list_iterator(list_iterator<T> const& other) : ptr(other.ptr) {}
         list_iterator& operator++() {
@@ -139,10 +296,16 @@ class list {
         return const_reverse_iterator(end());
     }
 
-    void push_back(T const& value) {
+    void push_back(T const& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
         node_base* last = loop.prev;
-        loop.prev = new node(value, last, &loop);
+        loop.prev = create_node(last, &loop, std::forward<Args>(args)...);
         last->next = loop.prev;
+        count++;
+        return static_cast<node*>(loop.prev)->value;
     }
 
     void pop_back() {
@@ -150,7 +313,8 @@ class list {
         node_base* to_del = loop.prev;
         loop.prev->prev->next = &loop;
         loop.prev = loop.prev->prev;
-        delete to_del;
+        count--;
+        destroy_node(to_del);
     }
 
     T& back() {
@@ -162,17 +326,25 @@ class list {
         return static_cast<node*>(loop.prev)->value;
     }
 
-    void push_front(T const& value) {
+    void push_front(T const& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args) {
         node_base* first = loop.next;
-        loop.next = new node(value, &loop, first);
+        loop.next = create_node(&loop, first, std::forward<Args>(args)...);
         first->prev = loop.next;
+        count++;
+        return static_cast<node*>(loop.next)->value;
     }
+
     void pop_front() {
         assert(&loop != loop.next);
         node_base* to_del = loop.next;
         loop.next->next->prev = &loop;
         loop.next = loop.next->next;
-        delete to_del;
+        count--;
+        destroy_node(to_del);
     }
 
     T& front() {
@@ -186,33 +358,99 @@ class list {
 
     bool empty() const { return &loop == loop.next; }
 
+    size_type size() const noexcept { return count; }
+
     void clear() {
+        if (pool.uses_slabs()) {
+            if (!std::is_trivially_destructible<T>::value) {
+                node_base* cur = loop.next;
+                while (cur != &loop) {
+                    node_base* to_del = cur;
+                    cur = cur->next;
+                    node_traits::destroy(alloc, static_cast<node*>(to_del));
+                }
+            }
+            loop.next = loop.prev = &loop;
+            count = 0;
+            pool.release_slabs(alloc);
+            return;
+        }
         node_base* cur = loop.next;
         while (cur != &loop) {
             node_base* to_del = cur;
             cur = cur->next;
-            delete to_del;
+            destroy_node(to_del);
         }
         loop.next = loop.prev = &loop;
+        count = 0;
     }
 
     iterator insert(const_iterator pos, T const& value) {
+        return emplace(pos, value);
+    }
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
         auto p1 = pos;
-        p1.ptr->prev = new node(value, p1.ptr->prev, p1.ptr);
+        p1.ptr->prev =
+            create_node(p1.ptr->prev, p1.ptr, std::forward<Args>(args)...);
         p1.ptr->prev->prev->next = p1.ptr->prev;
+        count++;
         return iterator(p1.ptr->prev);
     }
 
+    // The bulk insertions build a detached chain first and link it in at
+    // the end, so the list is left untouched if an element throws.
+    template <typename InputIt, typename = require_input_iterator<InputIt>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        return link_before(pos.ptr, make_chain(first, last));
+    }
+
+    iterator insert(const_iterator pos, size_type n, T const& value) {
+        return link_before(pos.ptr, make_chain(n, value));
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> init_list) {
+        return insert(pos, init_list.begin(), init_list.end());
+    }
+
+    template <typename Range>
+    void append_range(Range&& range) {
+        using std::begin;
+        using std::end;
+        insert(this->end(), begin(range), end(range));
+    }
+
+    template <typename InputIt, typename = require_input_iterator<InputIt>>
+    void assign(InputIt first, InputIt last) {
+        replace_with(make_chain(first, last));
+    }
+
+    void assign(size_type n, T const& value) {
+        replace_with(make_chain(n, value));
+    }
+
+    void assign(std::initializer_list<T> init_list) {
+        assign(init_list.begin(), init_list.end());
+    }
+
     iterator erase(const_iterator pos) {
         assert(&loop != loop.next);
         pos.ptr->prev->next = pos.ptr->next;
         pos.ptr->next->prev = pos.ptr->prev;
         iterator to_ret(pos.ptr->next);
-        delete pos.ptr;
+        count--;
+        destroy_node(pos.ptr);
         return to_ret;
     }
 
     iterator erase(const_iterator begin, const_iterator end) {
+        if (begin == end) {
+            return iterator(end.ptr);
+        }
         node_base n;
         n.next = begin.ptr;
         n.prev = end.ptr->prev;
@@ -227,13 +465,56 @@ class list {
         while (cur != &n) {
             node_base* to_del = cur;
             cur = cur->next;
-            delete to_del;
+            count--;
+            destroy_node(to_del);
         }
         return iterator(end.ptr);
     }
 
-    void splice(const_iterator pos, list<T>& other, const_iterator begin,
+    // Nodes moved between lists must come from equal allocators. Slab nodes
+    // stay with the list that owns their slab: when either list uses slab
+    // storage, the elements are moved into new nodes instead, which makes
+    // the splice O(n) and invalidates iterators to the moved elements.
+    void splice(const_iterator pos, list& other) {
+        splice(pos, other, other.begin(), other.end(), other.count);
+    }
+
+    void splice(const_iterator pos, list& other, const_iterator it) {
+        const_iterator next = it;
+        ++next;
+        if (pos != it) {
+            splice(pos, other, it, next, 1);
+        }
+    }
+
+    void splice(const_iterator pos, list& other, const_iterator begin,
                 const_iterator end) {
+        size_type n = 0;
+        if (&other != this) {
+            for (auto it = begin; it != end; ++it) {
+                n++;
+            }
+        }
+        splice(pos, other, begin, end, n);
+    }
+
+    // n must be std::distance(begin, end); makes the splice O(1)
+    void splice(const_iterator pos, list& other, const_iterator begin,
+                const_iterator end, size_type n) {
+        if (begin == end || pos == end) {
+            return;
+        }
+        if (&other != this) {
+            if (pool.uses_slabs() || other.pool.uses_slabs()) {
+                for (auto it = begin; it != end; ++it) {
+                    emplace(pos, std::move(value_of(it.ptr)));
+                }
+                other.erase(begin, end);
+                return;
+            }
+            other.count -= n;
+            count += n;
+        }
         node_base* to_con_left = begin.ptr->prev;
 
         pos.ptr->prev->next = begin.ptr;
@@ -246,27 +527,549 @@ class list {
         to_con_left->next = end.ptr;
     }
 
-    template <typename U>
-    friend void swap(list<U>& a, list<U>& b) noexcept;
-};
+    // Merges the sorted other into this sorted list by relinking (by moving
+    // the elements if either list uses slab storage); equal elements of this
+    // list go first. other is left empty. If cmp throws while relinking,
+    // this list still holds every element of both, not in sorted order.
+    void merge(list& other) { merge(other, std::less<T>()); }
+    void merge(list&& other) { merge(other, std::less<T>()); }
+
+    template <typename Compare>
+    void merge(list&& other, Compare cmp) {
+        merge(other, cmp);
+    }
+
+    template <typename Compare>
+    void merge(list& other, Compare cmp) {
+        if (&other == this || other.empty()) {
+            return;
+        }
+        if (pool.uses_slabs() || other.pool.uses_slabs()) {
+            node_base* cur = loop.next;
+            for (node_base* src = other.loop.next; src != &other.loop;
+                 src = src->next) {
+                while (cur != &loop && !cmp(value_of(src), value_of(cur))) {
+                    cur = cur->next;
+                }
+                emplace(const_iterator(cur), std::move(value_of(src)));
+            }
+            other.clear();
+            return;
+        }
+        loop.prev->next = nullptr;
+        other.loop.prev->next = nullptr;
+        node_base head;
+        try {
+            merge_into(head, empty() ? nullptr : loop.next, other.loop.next,
+                       cmp);
+        } catch (...) {
+            // every node is still on head's chain, if out of order
+            count += other.count;
+            other.count = 0;
+            other.loop.next = other.loop.prev = &other.loop;
+            link_chain(head.next);
+            throw;
+        }
+        count += other.count;
+        other.count = 0;
+        other.loop.next = other.loop.prev = &other.loop;
+        link_chain(head.next);
+    }
+
+    size_type remove(T const& value) {
+        return remove_if([&value](T const& x) { return x == value; });
+    }
+
+    // Unlinks the matching nodes in one pass and destroys them afterwards,
+    // so pred may safely refer to an element of the list. If pred throws,
+    // the elements matched so far are removed and the rest are kept.
+    template <typename Predicate>
+    size_type remove_if(Predicate pred) {
+        node_base* removed = nullptr;
+        node_base* cur = loop.next;
+        try {
+            while (cur != &loop) {
+                node_base* next = cur->next;
+                if (pred(value_of(cur))) {
+                    unlink(cur, removed);
+                }
+                cur = next;
+            }
+        } catch (...) {
+            destroy_chain(removed);
+            throw;
+        }
+        return destroy_chain(removed);
+    }
+
+    size_type unique() { return unique(std::equal_to<T>()); }
+
+    template <typename BinaryPredicate>
+    size_type unique(BinaryPredicate pred) {
+        node_base* removed = nullptr;
+        if (!empty()) {
+            node_base* kept = loop.next;
+            node_base* cur = kept->next;
+            try {
+                while (cur != &loop) {
+                    node_base* next = cur->next;
+                    if (pred(value_of(kept), value_of(cur))) {
+                        unlink(cur, removed);
+                    } else {
+                        kept = cur;
+                    }
+                    cur = next;
+                }
+            } catch (...) {
+                destroy_chain(removed);
+                throw;
+            }
+        }
+        return destroy_chain(removed);
+    }
 
-template <typename U>
-void swap(list<U>& a, list<U>& b) noexcept {
-    auto a_left = a.loop.prev;
-    auto a_right = a.loop.next;
+    void reverse() noexcept {
+        node_base* cur = &loop;
+        do {
+            std::swap(cur->next, cur->prev);
+            cur = cur->prev;
+        } while (cur != &loop);
+    }
+
+    // Calls f on the elements in order while a second pointer runs distance
+    // nodes ahead and prefetches them, so the pointer chase overlaps with the
+    // work of f instead of stalling every step. Pays off on lists much larger
+    // than the cache whose nodes are scattered over the heap. f must not
+    // insert or erase elements.
+    template <typename F>
+    F for_each_prefetch(F f, size_type distance = 8) {
+        walk_prefetch(&loop, distance, [&f](node_base* p) { f(value_of(p)); });
+        return f;
+    }
+
+    template <typename F>
+    F for_each_prefetch(F f, size_type distance = 8) const {
+        walk_prefetch(&loop, distance, [&f](node_base* p) {
+            f(static_cast<T const&>(value_of(p)));
+        });
+        return f;
+    }
+
+    // Moves the elements into fresh nodes allocated in list order and frees
+    // the old ones, so that iteration walks memory sequentially again. The
+    // storage policy is kept: with slab storage the new nodes are carved
+    // from one slab and are adjacent; otherwise they are as close as the
+    // allocator places consecutive allocations (adjacent with an arena such
+    // as std::pmr::monotonic_buffer_resource). Values are moved (copied if
+    // their move may throw), so all iterators, pointers and references to
+    // elements are invalidated. Every node is allocated before the first
+    // value is moved, so if an allocation or a copy throws, the list is
+    // left unchanged.
+    void compact() {
+        if (empty()) {
+            return;
+        }
+        list tmp{Alloc(alloc)};
+        tmp.copy_storage_policy(*this);
+        tmp.pool.prefill(tmp.alloc, count);
+        for (node_base* cur = loop.next; cur != &loop; cur = cur->next) {
+            tmp.emplace_back(std::move_if_noexcept(value_of(cur)));
+        }
+        swap_nodes(tmp);
+    }
+
+    // Share of links, in list order, that do not lead to a node placed
+    // shortly after the current one in memory: 0 right after compact(), close
+    // to 1 when the nodes are scattered over the heap. O(size()).
+    double fragmentation() const noexcept {
+        if (count < 2) {
+            return 0;
+        }
+        size_type far = 0;
+        for (node_base* cur = loop.next; cur->next != &loop; cur = cur->next) {
+            auto from = reinterpret_cast<std::uintptr_t>(cur);
+            auto to = reinterpret_cast<std::uintptr_t>(cur->next);
+            if (to <= from || to - from > 2 * sizeof(node)) {
+                far++;
+            }
+        }
+        return static_cast<double>(far) / static_cast<double>(count - 1);
+    }
+
+    // Stable bottom-up merge sort that relinks the nodes; no element is
+    // copied or moved and nothing is allocated. cmp must not throw. This
+    // buys memory and stable nodes, not speed: on a large list every merge
+    // step chases pointers across the heap, so copying the values into a
+    // vector, sorting that and writing them back is several times faster
+    // when the extra buffer and the copies are acceptable.
+    void sort() { sort(std::less<T>()); }
+
+    template <typename Compare>
+    void sort(Compare cmp) {
+        if (count < 2) {
+            return;
+        }
+        loop.prev->next = nullptr;
+        link_chain(sort_chain(loop.next, cmp));
+    }
+
+    // Parallel variant: the chain is cut into one run per thread, the runs
+    // are sorted concurrently and then merged pairwise, also concurrently.
+    // cmp is shared between the threads and must be safe to call from
+    // several of them at once.
+    template <typename Compare>
+    void sort(Compare cmp, unsigned threads) {
+        const size_type min_run = 1 << 14;
+        if (threads > count / min_run) {
+            threads = static_cast<unsigned>(count / min_run);
+        }
+        if (threads < 2) {
+            sort(cmp);
+            return;
+        }
+        std::vector<node_base*> runs(threads);
+        node_base* cur = loop.next;
+        for (unsigned i = 0; i < threads; i++) {
+            runs[i] = cur;
+            size_type len = count / threads + (i < count % threads ? 1 : 0);
+            for (size_type j = 1; j < len; j++) {
+                cur = cur->next;
+            }
+            node_base* next = cur->next;
+            cur->next = nullptr;
+            cur = next;
+        }
+        run_parallel(threads, [&runs, &cmp](std::size_t i) {
+            runs[i] = sort_chain(runs[i], cmp);
+        });
+        for (std::size_t step = 1; step < threads; step *= 2) {
+            run_parallel((threads - 1) / (2 * step) + 1,
+                         [&runs, &cmp, step, threads](std::size_t i) {
+                             std::size_t left = 2 * step * i;
+                             if (left + step < threads) {
+                                 runs[left] = merge_chains(
+                                     runs[left], runs[left + step], cmp);
+                             }
+                         });
+        }
+        link_chain(runs[0]);
+    }
+
+   private:
+    static T& value_of(node_base* p) { return static_cast<node*>(p)->value; }
+
+    static void prefetch(node_base const* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p);
+#else
+        (void)p;
+#endif
+    }
+
+    template <typename F>
+    static void walk_prefetch(node_base const* end, size_type distance,
+                              F const& visit) {
+        node_base* cur = end->next;
+        node_base* ahead = cur;
+        for (size_type i = 0; i < distance && ahead != end; i++) {
+            ahead = ahead->next;
+            prefetch(ahead);
+        }
+        while (cur != end) {
+            if (ahead != end) {
+                ahead = ahead->next;
+                prefetch(ahead);
+            }
+            node_base* next = cur->next;
+            visit(cur);
+            cur = next;
+        }
+    }
+
+    // moves p out of the ring onto a null-terminated chain
+    void unlink(node_base* p, node_base*& chain) noexcept {
+        p->prev->next = p->next;
+        p->next->prev = p->prev;
+        p->next = chain;
+        chain = p;
+        count--;
+    }
+
+    // detached nodes linked through next and prev; last->next is null
+    struct chain {
+        node_base* first = nullptr;
+        node_base* last = nullptr;
+        std::size_t size = 0;
+    };
+
+    template <typename... Args>
+    void chain_append(chain& c, Args&&... args) {
+        node* p = create_node(c.last, nullptr, std::forward<Args>(args)...);
+        if (c.last != nullptr) {
+            c.last->next = p;
+        } else {
+            c.first = p;
+        }
+        c.last = p;
+        c.size++;
+    }
+
+    template <typename InputIt>
+    chain make_chain(InputIt first, InputIt last) {
+        chain c;
+        reserve_for(first, last,
+                    typename std::iterator_traits<InputIt>::iterator_category());
+        try {
+            for (; first != last; ++first) {
+                chain_append(c, *first);
+            }
+        } catch (...) {
+            destroy_chain(c.first);
+            throw;
+        }
+        return c;
+    }
+
+    chain make_chain(size_type n, T const& value) {
+        chain c;
+        reserve_storage(n);
+        try {
+            for (; n > 0; n--) {
+                chain_append(c, value);
+            }
+        } catch (...) {
+            destroy_chain(c.first);
+            throw;
+        }
+        return c;
+    }
 
-    auto b_left = b.loop.prev;
-    auto b_right = b.loop.next;
+    template <typename InputIt>
+    void reserve_for(InputIt, InputIt, std::input_iterator_tag) {}
 
-    a_left->next = &b.loop;
-    a_right->prev = &b.loop;
+    template <typename ForwardIt>
+    void reserve_for(ForwardIt first, ForwardIt last,
+                     std::forward_iterator_tag) {
+        reserve_storage(static_cast<std::size_t>(std::distance(first, last)));
+    }
 
-    b_left->next = &a.loop;
-    b_right->prev = &a.loop;
+    // links the chain in front of pos with four pointer writes
+    iterator link_before(node_base* pos, chain const& c) noexcept {
+        if (c.first == nullptr) {
+            return iterator(pos);
+        }
+        c.first->prev = pos->prev;
+        c.last->next = pos;
+        pos->prev->next = c.first;
+        pos->prev = c.last;
+        count += c.size;
+        return iterator(c.first);
+    }
 
-    std::swap(a.loop, b.loop);
+    void replace_with(chain const& c) {
+        node_base* old = empty() ? nullptr : loop.next;
+        loop.prev->next = nullptr;
+        loop.next = loop.prev = &loop;
+        count = 0;
+        link_before(&loop, c);
+        destroy_chain(old);
+    }
+
+    size_type destroy_chain(node_base* first) {
+        size_type n = 0;
+        while (first != nullptr) {
+            node_base* to_del = first;
+            first = first->next;
+            destroy_node(to_del);
+            n++;
+        }
+        return n;
+    }
+
+    // runs f(0) .. f(tasks - 1), each on its own thread; a task whose
+    // thread cannot be started runs on the calling thread
+    template <typename F>
+    static void run_parallel(std::size_t tasks, F const& f) {
+        std::vector<std::thread> workers;
+        workers.reserve(tasks);
+        for (std::size_t i = 1; i < tasks; i++) {
+            try {
+                workers.emplace_back(f, i);
+            } catch (std::system_error const&) {
+                f(i);
+            }
+        }
+        f(0);
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    // restores prev links and the ring from a null-terminated next chain
+    void link_chain(node_base* first) {
+        node_base* prev = &loop;
+        for (node_base* cur = first; cur != nullptr; cur = cur->next) {
+            cur->prev = prev;
+            prev->next = cur;
+            prev = cur;
+        }
+        prev->next = &loop;
+        loop.prev = prev;
+    }
+
+    // merges null-terminated sorted chains, taking from a on ties
+    template <typename Compare>
+    static node_base* merge_chains(node_base* a, node_base* b, Compare& cmp) {
+        node_base head;
+        merge_into(head, a, b, cmp);
+        return head.next;
+    }
+
+    // Merges a and b onto head.next. If cmp throws, the unmerged rest of a
+    // and then that of b are appended, so head.next still holds every node.
+    template <typename Compare>
+    static void merge_into(node_base& head, node_base* a, node_base* b,
+                           Compare& cmp) {
+        node_base* tail = &head;
+        try {
+            while (a != nullptr && b != nullptr) {
+                if (cmp(value_of(b), value_of(a))) {
+                    tail->next = b;
+                    b = b->next;
+                } else {
+                    tail->next = a;
+                    a = a->next;
+                }
+                tail = tail->next;
+            }
+        } catch (...) {
+            for (; a != nullptr; a = a->next) {
+                tail = tail->next = a;
+            }
+            tail->next = b;
+            throw;
+        }
+        tail->next = a != nullptr ? a : b;
+    }
+
+    template <typename Compare>
+    static node_base* sort_chain(node_base* chain, Compare& cmp) {
+        // runs[i] is either empty or a sorted run of 2^i nodes that precede
+        // everything in runs[j] for j < i
+        node_base* runs[sizeof(std::size_t) * 8] = {};
+        std::size_t used = 0;
+        while (chain != nullptr) {
+            node_base* run = chain;
+            chain = chain->next;
+            run->next = nullptr;
+            std::size_t i = 0;
+            for (; runs[i] != nullptr; i++) {
+                run = merge_chains(runs[i], run, cmp);
+                runs[i] = nullptr;
+            }
+            runs[i] = run;
+            if (i == used) {
+                used++;
+            }
+        }
+        node_base* result = nullptr;
+        for (std::size_t i = 0; i < used; i++) {
+            if (runs[i] != nullptr) {
+                result = merge_chains(runs[i], result, cmp);
+            }
+        }
+        return result;
+    }
+
+    void swap_nodes(list& other) noexcept {
+        auto a_left = loop.prev;
+        auto a_right = loop.next;
+
+        auto b_left = other.loop.prev;
+        auto b_right = other.loop.next;
+
+        a_left->next = &other.loop;
+        a_right->prev = &other.loop;
+
+        b_left->next = &loop;
+        b_right->prev = &loop;
+
+        std::swap(loop, other.loop);
+        std::swap(count, other.count);
+        pool.swap(other.pool);
+    }
+
+    void swap_allocator(list& other, std::true_type) noexcept {
+        using std::swap;
+        swap(alloc, other.alloc);
+    }
+    void swap_allocator(list&, std::false_type) noexcept {}
+
+    void copy_allocator(list const& other, std::true_type) {
+        alloc = other.alloc;
+    }
+    void copy_allocator(list const&, std::false_type) {}
+
+    void move_allocator(list& other, std::true_type) noexcept {
+        alloc = std::move(other.alloc);
+    }
+    void move_allocator(list&, std::false_type) noexcept {}
+
+    // the nodes of other can be adopted as they are
+    void move_assign(list& other, std::true_type) noexcept {
+        clear();
+        trim_node_cache();
+        swap_nodes(other);
+        move_allocator(
+            other,
+            typename node_traits::propagate_on_container_move_assignment());
+    }
+
+    void move_assign(list& other, std::false_type) {
+        if (alloc == other.alloc) {
+            move_assign(other, std::true_type());
+            return;
+        }
+        clear();
+        for (node_base* cur = other.loop.next; cur != &other.loop;
+             cur = cur->next) {
+            push_back(std::move(static_cast<node*>(cur)->value));
+        }
+        other.clear();
+    }
+
+    // makes an empty list store its nodes the way other does
+    void copy_storage_policy(list const& other) {
+        pool.set_limit(other.pool.limit());
+        if (other.pool.uses_slabs()) {
+            use_slab_storage(other.pool.first_slab());
+        }
+    }
+
+    void append_copy(list const& other) {
+        link_before(&loop, make_chain(other.begin(), other.end()));
+    }
+
+    template <typename U, typename A>
+    friend void swap(list<U, A>& a, list<U, A>& b) noexcept;
+};
+
+template <typename U, typename A>
+void swap(list<U, A>& a, list<U, A>& b) noexcept {
+    a.swap_nodes(b);
+    a.swap_allocator(
+        b, typename list<U, A>::node_traits::propagate_on_container_swap());
 }
 
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+namespace pmr {
+
+template <typename T>
+using list = my::list<T, std::pmr::polymorphic_allocator<T>>;
+
+}  // namespace pmr
+#endif
+
 }  // namespace my
 
 #endif  // MY_LIST
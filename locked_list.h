@@ -0,0 +1,139 @@
+#ifndef MY_LOCKED_LIST
+#define MY_LOCKED_LIST
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace my {
+
+// Sorted list shared between threads, with a mutex in every node. An
+// operation walks hand over hand: it locks the next node before releasing
+// the previous one, so it never holds more than two locks and threads
+// working on disjoint parts of the list do not wait for each other. A node
+// is unlinked with its predecessor and itself locked, which keeps every
+// other thread out of it, so it can be freed right away.
+template <typename T, typename Compare = std::less<T>>
+class locked_list {
+   private:
+    struct node_base {
+        node_base* next = nullptr;
+        std::mutex lock;
+    };
+
+    struct node : node_base {
+        T value;
+
+        template <typename... Args>
+        explicit node(Args&&... args) : value(std::forward<Args>(args)...) {}
+    };
+
+    using guard = std::unique_lock<std::mutex>;
+
+    node_base head;
+    std::atomic<std::size_t> count{0};
+    Compare cmp;
+
+    static T& value_of(node_base* p) { return static_cast<node*>(p)->value; }
+
+    // Walks to the first node not less than value (or past the last node);
+    // returns its predecessor with both locks held. cur is null at the end
+    // and then owns no mutex.
+    template <typename U>
+    node_base* find(U const& value, guard& prev_lock, guard& cur_lock) {
+        node_base* prev = &head;
+        prev_lock = guard(prev->lock);
+        node_base* cur = prev->next;
+        while (cur != nullptr) {
+            cur_lock = guard(cur->lock);
+            if (!cmp(value_of(cur), value)) {
+                return prev;
+            }
+            prev_lock = std::move(cur_lock);
+            prev = cur;
+            cur = cur->next;
+        }
+        return prev;
+    }
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    locked_list() = default;
+    explicit locked_list(Compare const& c) : cmp(c) {}
+
+    locked_list(locked_list const&) = delete;
+    locked_list& operator=(locked_list const&) = delete;
+
+    // no other thread may use the list any more
+    ~locked_list() {
+        node_base* cur = head.next;
+        while (cur != nullptr) {
+            node_base* next = cur->next;
+            delete static_cast<node*>(cur);
+            cur = next;
+        }
+    }
+
+    // inserts in front of the first element not less than value
+    void insert(T const& value) { emplace(value); }
+    void insert(T&& value) { emplace(std::move(value)); }
+
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        // owned until linked, in case cmp throws
+        std::unique_ptr<node> n(new node(std::forward<Args>(args)...));
+        guard prev_lock, cur_lock;
+        node_base* prev = find(n->value, prev_lock, cur_lock);
+        n->next = prev->next;
+        prev->next = n.release();
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // erases one element equal to value; false if there is none
+    bool erase(T const& value) {
+        guard prev_lock, cur_lock;
+        node_base* prev = find(value, prev_lock, cur_lock);
+        node_base* cur = prev->next;
+        if (cur == nullptr || cmp(value, value_of(cur))) {
+            return false;
+        }
+        prev->next = cur->next;
+        cur_lock.unlock();
+        delete static_cast<node*>(cur);
+        count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool contains(T const& value) {
+        guard prev_lock, cur_lock;
+        node_base* cur = find(value, prev_lock, cur_lock)->next;
+        return cur != nullptr && !cmp(value, value_of(cur));
+    }
+
+    // Calls f on the elements in order, each while its node is locked. f
+    // must not call back into the list.
+    template <typename F>
+    void for_each(F f) {
+        guard prev_lock(head.lock);
+        for (node_base* cur = head.next; cur != nullptr; cur = cur->next) {
+            guard cur_lock(cur->lock);
+            prev_lock = std::move(cur_lock);
+            f(static_cast<T const&>(value_of(cur)));
+        }
+    }
+
+    // exact only while no other thread modifies the list
+    size_type size() const noexcept {
+        return count.load(std::memory_order_relaxed);
+    }
+    bool empty() const noexcept { return size() == 0; }
+};
+
+}  // namespace my
+
+#endif  // MY_LOCKED_LIST
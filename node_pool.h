@@ -0,0 +1,181 @@
+#ifndef MY_NODE_POOL
+#define MY_NODE_POOL
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace my {
+namespace detail {
+
+// Node storage shared by the node based containers. Freed storage goes to a
+// free list (bounded by the cache limit, or unbounded with slab storage),
+// and with slab storage nodes are carved out of slabs of growing size. The
+// pool holds no allocator: the container passes its own, so allocator
+// propagation stays the container's business.
+template <typename Node, typename NodeAlloc>
+class node_pool {
+   private:
+    using node_traits = std::allocator_traits<NodeAlloc>;
+
+    struct free_slot {
+        free_slot* next;
+    };
+
+    // the first slot of every slab holds its header
+    struct slab {
+        slab* next;
+        std::size_t capacity;
+    };
+    static_assert(sizeof(slab) <= sizeof(Node) &&
+                      alignof(slab) <= alignof(Node),
+                  "slab header must fit into a node slot");
+
+    free_slot* cache = nullptr;
+    std::size_t cache_size = 0;
+    std::size_t cache_limit = 0;
+
+    slab* slabs = nullptr;
+    Node* slab_cur = nullptr;
+    Node* slab_end = nullptr;
+    std::size_t slab_first = 0;
+    std::size_t slab_next = 0;
+
+    void grow_slab(NodeAlloc& alloc, std::size_t capacity) {
+        Node* p = node_traits::allocate(alloc, capacity);
+        slabs = ::new (static_cast<void*>(p)) slab{slabs, capacity};
+        slab_cur = p + 1;
+        slab_end = p + capacity;
+        slab_next = 2 * capacity;
+    }
+
+   public:
+    node_pool() = default;
+    node_pool(node_pool const&) = delete;
+    node_pool& operator=(node_pool const&) = delete;
+
+    std::size_t cached() const noexcept { return cache_size; }
+    std::size_t limit() const noexcept { return cache_limit; }
+    void set_limit(std::size_t limit) noexcept { cache_limit = limit; }
+
+    // 0 when nodes are allocated one by one
+    std::size_t first_slab() const noexcept { return slab_first; }
+    bool uses_slabs() const noexcept { return slab_first != 0; }
+
+    // the pool must hold no storage; first is raised to 2, as the header
+    // takes a slot of every slab
+    void use_slabs(std::size_t first) noexcept {
+        slab_first = slab_next = std::max<std::size_t>(first, 2);
+    }
+
+    Node* take(NodeAlloc& alloc) {
+        if (cache == nullptr) {
+            if (slab_first == 0) {
+                return node_traits::allocate(alloc, 1);
+            }
+            if (slab_cur == slab_end) {
+                grow_slab(alloc, slab_next);
+            }
+            return slab_cur++;
+        }
+        free_slot* p = cache;
+        cache = cache->next;
+        cache_size--;
+        return static_cast<Node*>(static_cast<void*>(p));
+    }
+
+    void give_back(NodeAlloc& alloc, Node* p) {
+        if (slab_first != 0 || cache_size < cache_limit) {
+            cache = ::new (static_cast<void*>(p)) free_slot{cache};
+            cache_size++;
+        } else {
+            node_traits::deallocate(alloc, p, 1);
+        }
+    }
+
+    // lets the next n takes share a single allocation with slab storage
+    void reserve(NodeAlloc& alloc, std::size_t n) {
+        if (slab_first == 0 ||
+            cache_size + static_cast<std::size_t>(slab_end - slab_cur) >= n) {
+            return;
+        }
+        while (slab_cur != slab_end) {
+            give_back(alloc, slab_cur++);
+        }
+        grow_slab(alloc, std::max(slab_next, n - cache_size + 1));
+    }
+
+    // Caches n nodes allocated one by one, which take hands out in the
+    // order they were allocated, so that the next n takes cannot fail. With
+    // slab storage the same as reserve. If an allocation throws, the nodes
+    // allocated so far stay cached.
+    void prefill(NodeAlloc& alloc, std::size_t n) {
+        if (slab_first != 0) {
+            reserve(alloc, n);
+            return;
+        }
+        free_slot* first = nullptr;
+        free_slot** link = &first;
+        try {
+            for (; n > 0; n--) {
+                Node* p = node_traits::allocate(alloc, 1);
+                *link = ::new (static_cast<void*>(p)) free_slot{nullptr};
+                link = &(*link)->next;
+                cache_size++;
+            }
+        } catch (...) {
+            *link = cache;
+            cache = first;
+            throw;
+        }
+        *link = cache;
+        cache = first;
+    }
+
+    // frees the cached storage above keep; a no-op with slab storage, whose
+    // nodes go back only with release_slabs
+    void trim(NodeAlloc& alloc, std::size_t keep = 0) {
+        if (slab_first != 0) {
+            return;
+        }
+        while (cache_size > keep) {
+            free_slot* p = cache;
+            cache = cache->next;
+            cache_size--;
+            node_traits::deallocate(
+                alloc, static_cast<Node*>(static_cast<void*>(p)), 1);
+        }
+    }
+
+    // all nodes carved from the slabs must be destroyed already
+    void release_slabs(NodeAlloc& alloc) {
+        while (slabs != nullptr) {
+            slab* s = slabs;
+            slabs = s->next;
+            node_traits::deallocate(
+                alloc, static_cast<Node*>(static_cast<void*>(s)), s->capacity);
+        }
+        slab_cur = slab_end = nullptr;
+        slab_next = slab_first;
+        cache = nullptr;
+        cache_size = 0;
+    }
+
+    void swap(node_pool& other) noexcept {
+        std::swap(cache, other.cache);
+        std::swap(cache_size, other.cache_size);
+        std::swap(cache_limit, other.cache_limit);
+        std::swap(slabs, other.slabs);
+        std::swap(slab_cur, other.slab_cur);
+        std::swap(slab_end, other.slab_end);
+        std::swap(slab_first, other.slab_first);
+        std::swap(slab_next, other.slab_next);
+    }
+};
+
+}  // namespace detail
+}  // namespace my
+
+#endif  // MY_NODE_POOL
@@ -0,0 +1,375 @@
+#ifndef MY_RCU_LIST
+#define MY_RCU_LIST
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace my {
+
+// Read-mostly singly linked list in the read-copy-update style. Readers
+// register once and then bracket every traversal with lock() / unlock(),
+// which only publish the current epoch in the reader's own slot; the walk
+// itself is plain acquire loads, with no lock and no shared write.
+// Writers are serialised by a mutex, publish every change with a release
+// store on a link and never modify a value in place: update_if links a
+// modified copy instead. Unlinked nodes are freed once every reader that
+// might still see them has left its read section (the grace period).
+template <typename T>
+class rcu_list {
+   private:
+    struct node {
+        std::atomic<node*> next;
+        T value;
+
+        template <typename... Args>
+        explicit node(node* n, Args&&... args)
+            : next(n), value(std::forward<Args>(args)...) {}
+    };
+
+    // 0 while the reader is outside a read section
+    struct reader_slot {
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> taken{true};
+        reader_slot* next = nullptr;
+    };
+
+    struct retired_node {
+        node* p;
+        std::uint64_t epoch;
+    };
+
+    std::atomic<node*> first{nullptr};
+    std::atomic<std::uint64_t> epoch{1};
+    std::atomic<reader_slot*> readers{nullptr};
+
+    // writer state, guarded by writer
+    std::mutex writer;
+    node* last = nullptr;
+    std::size_t count = 0;
+    std::vector<retired_node> retired;
+
+    reader_slot* take_slot() {
+        for (reader_slot* s = readers.load(std::memory_order_acquire);
+             s != nullptr; s = s->next) {
+            bool expected = false;
+            if (!s->taken.load(std::memory_order_relaxed) &&
+                s->taken.compare_exchange_strong(expected, true,
+                                                 std::memory_order_acquire)) {
+                return s;
+            }
+        }
+        reader_slot* s = new reader_slot;
+        reader_slot* head = readers.load(std::memory_order_relaxed);
+        do {
+            s->next = head;
+        } while (!readers.compare_exchange_weak(head, s,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+        return s;
+    }
+
+    // the oldest epoch a reader is still in, or the current epoch if none
+    std::uint64_t oldest_reader() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t oldest = epoch.load();
+        for (reader_slot* s = readers.load(std::memory_order_acquire);
+             s != nullptr; s = s->next) {
+            std::uint64_t e = s->epoch.load(std::memory_order_acquire);
+            if (e != 0 && e < oldest) {
+                oldest = e;
+            }
+        }
+        return oldest;
+    }
+
+    // called by the writer after unlinking p
+    void retire(node* p) {
+        retired.push_back({p, epoch.fetch_add(1)});
+        reclaim();
+    }
+
+    // frees the nodes no reader can reach any more: a reader that entered
+    // in a later epoch than the unlink started its walk after it
+    void reclaim() {
+        if (retired.empty()) {
+            return;
+        }
+        std::uint64_t oldest = oldest_reader();
+        std::size_t kept = 0;
+        for (auto const& r : retired) {
+            if (r.epoch < oldest) {
+                delete r.p;
+            } else {
+                retired[kept++] = r;
+            }
+        }
+        retired.resize(kept);
+    }
+
+    // links n after prev (null for the front)
+    void link_after(node* prev, node* n) {
+        std::atomic<node*>& link = prev == nullptr ? first : prev->next;
+        n->next.store(link.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+        link.store(n, std::memory_order_release);
+        if (prev == last) {
+            last = n;
+        }
+        count++;
+    }
+
+    template <typename U>
+    struct rcu_iterator;
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_iterator = rcu_iterator<T const>;
+    using iterator = const_iterator;
+
+    // A registered reader, to be used by one thread at a time. lock() and
+    // unlock() bracket a read section: iterators into the list are valid
+    // only inside one. Read sections must not nest and must not call the
+    // writer side of the same list, which may wait for them.
+    class reader {
+       public:
+        reader(reader&& other) noexcept : list(other.list), slot(other.slot) {
+            other.slot = nullptr;
+        }
+        reader& operator=(reader&& other) noexcept {
+            std::swap(list, other.list);
+            std::swap(slot, other.slot);
+            return *this;
+        }
+        reader(reader const&) = delete;
+        reader& operator=(reader const&) = delete;
+
+        ~reader() {
+            if (slot != nullptr) {
+                slot->epoch.store(0, std::memory_order_release);
+                slot->taken.store(false, std::memory_order_release);
+            }
+        }
+
+        void lock() noexcept {
+            slot->epoch.store(list->epoch.load(std::memory_order_relaxed),
+                              std::memory_order_relaxed);
+            // the links must not be read before the epoch is visible
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        void unlock() noexcept {
+            slot->epoch.store(0, std::memory_order_release);
+        }
+
+        // f sees every element in one read section
+        template <typename F>
+        void for_each(F f) {
+            std::lock_guard<reader> section(*this);
+            for (T const& x : *list) {
+                f(x);
+            }
+        }
+
+       private:
+        friend class rcu_list;
+        reader(rcu_list const* l, reader_slot* s) : list(l), slot(s) {}
+
+        rcu_list const* list;
+        reader_slot* slot;
+    };
+
+    rcu_list() = default;
+    rcu_list(rcu_list const&) = delete;
+    rcu_list& operator=(rcu_list const&) = delete;
+
+    // no reader may be registered any more
+    ~rcu_list() {
+        for (auto const& r : retired) {
+            delete r.p;
+        }
+        node* p = first.load(std::memory_order_relaxed);
+        while (p != nullptr) {
+            node* next = p->next.load(std::memory_order_relaxed);
+            delete p;
+            p = next;
+        }
+        reader_slot* s = readers.load(std::memory_order_relaxed);
+        while (s != nullptr) {
+            reader_slot* next = s->next;
+            delete s;
+            s = next;
+        }
+    }
+
+    reader register_reader() { return reader(this, take_slot()); }
+
+   private:
+    template <typename U>
+    struct rcu_iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        friend class rcu_list;
+        rcu_iterator() = default;
+
+        rcu_iterator& operator++() {
+            ptr = ptr->next.load(std::memory_order_acquire);
+            return *this;
+        }
+        rcu_iterator operator++(int) {
+            rcu_iterator old(*this);
+            ++*this;
+            return old;
+        }
+
+        U& operator*() const { return ptr->value; }
+        U* operator->() const { return &ptr->value; }
+
+        bool operator==(rcu_iterator const& other) const {
+            return ptr == other.ptr;
+        }
+        bool operator!=(rcu_iterator const& other) const {
+            return ptr != other.ptr;
+        }
+
+       private:
+        explicit rcu_iterator(node* p) : ptr(p) {}
+        node* ptr = nullptr;
+    };
+
+   public:
+    // inside a read section, or on the writer's thread
+    const_iterator begin() const {
+        return const_iterator(first.load(std::memory_order_acquire));
+    }
+    const_iterator end() const { return const_iterator(nullptr); }
+
+    // writer side: every call below takes the writer mutex
+
+    void push_front(T const& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    template <typename... Args>
+    void emplace_front(Args&&... args) {
+        node* n = new node(nullptr, std::forward<Args>(args)...);
+        std::lock_guard<std::mutex> lock(writer);
+        link_after(nullptr, n);
+    }
+
+    void push_back(T const& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args) {
+        node* n = new node(nullptr, std::forward<Args>(args)...);
+        std::lock_guard<std::mutex> lock(writer);
+        link_after(last, n);
+    }
+
+    // unlinks the matching elements; they are freed after a grace period
+    template <typename Predicate>
+    size_type remove_if(Predicate pred) {
+        std::lock_guard<std::mutex> lock(writer);
+        size_type removed = 0;
+        node* prev = nullptr;
+        node* cur = first.load(std::memory_order_relaxed);
+        while (cur != nullptr) {
+            node* next = cur->next.load(std::memory_order_relaxed);
+            if (pred(static_cast<T const&>(cur->value))) {
+                (prev == nullptr ? first : prev->next)
+                    .store(next, std::memory_order_release);
+                if (cur == last) {
+                    last = prev;
+                }
+                count--;
+                removed++;
+                retire(cur);
+            } else {
+                prev = cur;
+            }
+            cur = next;
+        }
+        return removed;
+    }
+
+    size_type remove(T const& value) {
+        return remove_if([&value](T const& x) { return x == value; });
+    }
+
+    // Replaces every matching element by a copy modified with f, linked in
+    // its place with one release store, so a reader sees either the old or
+    // the new value, never a half-updated one.
+    template <typename Predicate, typename F>
+    size_type update_if(Predicate pred, F f) {
+        std::lock_guard<std::mutex> lock(writer);
+        size_type updated = 0;
+        node* prev = nullptr;
+        node* cur = first.load(std::memory_order_relaxed);
+        while (cur != nullptr) {
+            node* next = cur->next.load(std::memory_order_relaxed);
+            if (pred(static_cast<T const&>(cur->value))) {
+                node* copy = new node(next, cur->value);
+                try {
+                    f(copy->value);
+                } catch (...) {
+                    delete copy;
+                    throw;
+                }
+                (prev == nullptr ? first : prev->next)
+                    .store(copy, std::memory_order_release);
+                if (cur == last) {
+                    last = copy;
+                }
+                updated++;
+                retire(cur);
+                cur = copy;
+            }
+            prev = cur;
+            cur = next;
+        }
+        return updated;
+    }
+
+    void clear() {
+        remove_if([](T const&) { return true; });
+    }
+
+    // Waits until every read section that could still see an unlinked node
+    // has ended and frees all of them. Must not be called from inside a
+    // read section.
+    void synchronize() {
+        std::lock_guard<std::mutex> lock(writer);
+        std::uint64_t target = epoch.fetch_add(1) + 1;
+        while (oldest_reader() < target) {
+            std::this_thread::yield();
+        }
+        reclaim();
+    }
+
+    // unlinked nodes still waiting for their grace period
+    size_type pending_reclaim() {
+        std::lock_guard<std::mutex> lock(writer);
+        return retired.size();
+    }
+
+    size_type size() {
+        std::lock_guard<std::mutex> lock(writer);
+        return count;
+    }
+    bool empty() { return size() == 0; }
+};
+
+}  // namespace my
+
+#endif  // MY_RCU_LIST
@@ -0,0 +1,537 @@
+#ifndef MY_UNROLLED_LIST
+#define MY_UNROLLED_LIST
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+// Doubly linked ring of nodes holding up to N elements each. Elements of a
+// node occupy the slots [lo, hi), so both ends can grow in place. Inserting
+// or erasing in the middle shifts at most one node worth of elements and
+// invalidates the iterators into that node only (and into the neighbour it
+// is merged with, see erase).
+template <typename T, std::size_t N = 32, typename Alloc = std::allocator<T>>
+class unrolled_list {
+    static_assert(N > 1, "a node must hold at least two elements");
+
+   private:
+    // the sentinel keeps lo == hi == 0, so iterators need no special case
+    // for end()
+    struct node_base {
+        node_base* next;
+        node_base* prev;
+        std::size_t lo;
+        std::size_t hi;
+        node_base() : next(nullptr), prev(nullptr), lo(0), hi(0) {}
+        node_base(node_base* p, node_base* n, std::size_t start)
+            : next(n), prev(p), lo(start), hi(start) {}
+        std::size_t size() const { return hi - lo; }
+    };
+
+    struct node : node_base {
+        alignas(T) unsigned char storage[N * sizeof(T)];
+
+        node(node_base* p, node_base* n, std::size_t start)
+            : node_base(p, n, start) {}
+
+        T* slot(std::size_t i) {
+            return reinterpret_cast<T*>(storage) + i;
+        }
+    };
+
+    using node_allocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    node_base loop;
+    std::size_t count = 0;
+    node_allocator alloc;
+
+    static node* as_node(node_base* p) { return static_cast<node*>(p); }
+
+    // links an empty node whose elements will start at slot start
+    node* create_node(node_base* prev, node_base* next, std::size_t start) {
+        node* p = node_traits::allocate(alloc, 1);
+        ::new (static_cast<void*>(p)) node(prev, next, start);
+        prev->next = p;
+        next->prev = p;
+        return p;
+    }
+
+    void destroy_node(node* p) {
+        for (std::size_t i = p->lo; i < p->hi; i++) {
+            node_traits::destroy(alloc, p->slot(i));
+        }
+        p->prev->next = p->next;
+        p->next->prev = p->prev;
+        node_traits::deallocate(alloc, p, 1);
+    }
+
+    template <typename U>
+    struct unrolled_iterator;
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+    using iterator = unrolled_iterator<T>;
+    using const_iterator = unrolled_iterator<T const>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    unrolled_list() noexcept(noexcept(node_allocator())) : alloc() {
+        loop.next = loop.prev = &loop;
+    }
+
+    explicit unrolled_list(Alloc const& a) noexcept : alloc(a) {
+        loop.next = loop.prev = &loop;
+    }
+
+    unrolled_list(std::initializer_list<T> init_list, Alloc const& a = Alloc())
+        : unrolled_list(a) {
+        for (auto const& x : init_list) {
+            push_back(x);
+        }
+    }
+
+    unrolled_list(unrolled_list const& other)
+        : unrolled_list(Alloc(
+              node_traits::select_on_container_copy_construction(other.alloc))) {
+        for (auto const& x : other) {
+            push_back(x);
+        }
+    }
+
+    unrolled_list(unrolled_list&& other) noexcept
+        : alloc(std::move(other.alloc)) {
+        loop.next = loop.prev = &loop;
+        swap_nodes(other);
+    }
+
+    unrolled_list& operator=(unrolled_list const& other) {
+        if (this != &other) {
+            using propagate =
+                typename node_traits::propagate_on_container_copy_assignment;
+            // our nodes cannot outlive the allocator that made them
+            unrolled_list tmp(other,
+                              Alloc(propagate::value ? other.alloc : alloc));
+            swap_nodes(tmp);
+            swap_allocator(tmp, propagate());
+        }
+        return *this;
+    }
+
+    unrolled_list& operator=(unrolled_list&& other) noexcept(
+        node_traits::propagate_on_container_move_assignment::value ||
+        node_traits::is_always_equal::value) {
+        if (this != &other) {
+            move_assign(
+                other,
+                std::integral_constant<
+                    bool,
+                    node_traits::propagate_on_container_move_assignment::value ||
+                        node_traits::is_always_equal::value>());
+        }
+        return *this;
+    }
+
+    ~unrolled_list() { clear(); }
+
+    unrolled_list(unrolled_list const& other, Alloc const& a)
+        : unrolled_list(a) {
+        for (auto const& x : other) {
+            push_back(x);
+        }
+    }
+
+    allocator_type get_allocator() const { return Alloc(alloc); }
+
+   private:
+    template <typename U>
+    struct unrolled_iterator {
+       public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename std::remove_const<U>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        friend class unrolled_list;
+        unrolled_iterator() = default;
+        unrolled_iterator(unrolled_iterator<T> const& other)
+            : ptr(other.ptr), index(other.index) {}
+
+        unrolled_iterator& operator++() {
+            if (++index == ptr->hi) {
+                ptr = ptr->next;
+                index = ptr->lo;
+            }
+            return *this;
+        }
+        unrolled_iterator operator++(int) {
+            unrolled_iterator old(*this);
+            ++*this;
+            return old;
+        }
+        unrolled_iterator& operator--() {
+            if (index == ptr->lo) {
+                ptr = ptr->prev;
+                index = ptr->hi - 1;
+            } else {
+                index--;
+            }
+            return *this;
+        }
+        unrolled_iterator operator--(int) {
+            unrolled_iterator old(*this);
+            --*this;
+            return old;
+        }
+
+        U& operator*() const { return *as_node(ptr)->slot(index); }
+        U* operator->() const { return as_node(ptr)->slot(index); }
+
+        template <typename Z>
+        bool operator==(unrolled_iterator<Z> const& other) const {
+            return ptr == other.ptr && index == other.index;
+        }
+        template <typename Z>
+        bool operator!=(unrolled_iterator<Z> const& other) const {
+            return !(*this == other);
+        }
+
+       private:
+        unrolled_iterator(node_base* p, std::size_t i) : ptr(p), index(i) {}
+
+        node_base* ptr = nullptr;
+        std::size_t index = 0;
+
+        template <typename Z>
+        friend struct unrolled_iterator;
+    };
+
+   public:
+    iterator begin() { return iterator(loop.next, loop.next->lo); }
+    const_iterator begin() const {
+        return const_iterator(loop.next, loop.next->lo);
+    }
+    iterator end() { return iterator(&loop, 0); }
+    const_iterator end() const {
+        return const_iterator(const_cast<node_base*>(&loop), 0);
+    }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const { return count == 0; }
+    size_type size() const noexcept { return count; }
+
+    T& front() {
+        assert(!empty());
+        return *begin();
+    }
+    T const& front() const {
+        assert(!empty());
+        return *begin();
+    }
+    T& back() {
+        assert(!empty());
+        node* last = as_node(loop.prev);
+        return *last->slot(last->hi - 1);
+    }
+    T const& back() const {
+        assert(!empty());
+        node* last = as_node(loop.prev);
+        return *last->slot(last->hi - 1);
+    }
+
+    void push_back(T const& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(T const& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        bool fresh = loop.prev == &loop || loop.prev->hi == N;
+        node* last =
+            fresh ? create_node(loop.prev, &loop, 0) : as_node(loop.prev);
+        try {
+            node_traits::construct(alloc, last->slot(last->hi),
+                                   std::forward<Args>(args)...);
+        } catch (...) {
+            if (fresh) {
+                destroy_node(last);
+            }
+            throw;
+        }
+        count++;
+        return *last->slot(last->hi++);
+    }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args) {
+        bool fresh = loop.next == &loop || loop.next->lo == 0;
+        node* first =
+            fresh ? create_node(&loop, loop.next, N) : as_node(loop.next);
+        try {
+            node_traits::construct(alloc, first->slot(first->lo - 1),
+                                   std::forward<Args>(args)...);
+        } catch (...) {
+            if (fresh) {
+                destroy_node(first);
+            }
+            throw;
+        }
+        count++;
+        return *first->slot(--first->lo);
+    }
+
+    void pop_back() {
+        assert(!empty());
+        node* last = as_node(loop.prev);
+        node_traits::destroy(alloc, last->slot(--last->hi));
+        count--;
+        if (last->size() == 0) {
+            destroy_node(last);
+        }
+    }
+
+    void pop_front() {
+        assert(!empty());
+        node* first = as_node(loop.next);
+        node_traits::destroy(alloc, first->slot(first->lo++));
+        count--;
+        if (first->size() == 0) {
+            destroy_node(first);
+        }
+    }
+
+    iterator insert(const_iterator pos, T const& value) {
+        return emplace(pos, value);
+    }
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    // Shifts the shorter side of the node towards its free slots; a full
+    // node is split in half first.
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        if (pos.ptr == &loop) {
+            emplace_back(std::forward<Args>(args)...);
+            return iterator(loop.prev, loop.prev->hi - 1);
+        }
+        T tmp(std::forward<Args>(args)...);
+        node* n = as_node(pos.ptr);
+        std::size_t i = pos.index;
+        if (n->size() == N) {
+            split(n);
+            if (i >= n->hi) {
+                i -= n->hi;
+                n = as_node(n->next);
+            }
+        }
+        if (n->hi < N && (n->lo == 0 || i - n->lo >= n->hi - i)) {
+            shift_right(n, i, tmp);
+        } else {
+            shift_left(n, i, tmp);
+            i--;
+        }
+        count++;
+        return iterator(n, i);
+    }
+
+    // A node left less than half full is merged with a neighbour if their
+    // elements fit into one node, which invalidates the iterators into
+    // that neighbour too.
+    iterator erase(const_iterator pos) {
+        assert(!empty() && pos.ptr != &loop);
+        node* n = as_node(pos.ptr);
+        std::size_t i = pos.index;
+        count--;
+        if (n->size() == 1) {
+            node_base* next = n->next;
+            destroy_node(n);
+            return iterator(next, next->lo);
+        }
+        if (i - n->lo < n->hi - 1 - i) {
+            std::move_backward(n->slot(n->lo), n->slot(i), n->slot(i + 1));
+            node_traits::destroy(alloc, n->slot(n->lo++));
+            i++;
+        } else {
+            std::move(n->slot(i + 1), n->slot(n->hi), n->slot(i));
+            node_traits::destroy(alloc, n->slot(--n->hi));
+        }
+
+        // the returned element is the one at offset off from the start of
+        // n, where n->size() stands for the first one of the next node
+        std::size_t off = i - n->lo;
+        node* left = n;
+        if (n->size() < N / 2) {
+            node_base* next = n->next;
+            node_base* prev = n->prev;
+            if (next != &loop && n->size() + next->size() <= N) {
+                absorb(n, as_node(next));
+            } else if (prev != &loop && prev->size() + n->size() <= N) {
+                left = as_node(prev);
+                off += left->size();
+                absorb(left, n);
+            }
+        }
+        i = left->lo + off;
+        if (i == left->hi) {
+            return iterator(left->next, left->next->lo);
+        }
+        return iterator(left, i);
+    }
+
+    void clear() {
+        while (loop.next != &loop) {
+            destroy_node(as_node(loop.next));
+        }
+        count = 0;
+    }
+
+    template <typename U, std::size_t M, typename A>
+    friend void swap(unrolled_list<U, M, A>& a,
+                     unrolled_list<U, M, A>& b) noexcept;
+
+   private:
+    // moves [i, hi) one slot right and puts value into slot i
+    void shift_right(node* n, std::size_t i, T& value) {
+        if (i == n->hi) {
+            node_traits::construct(alloc, n->slot(i), std::move(value));
+        } else {
+            node_traits::construct(alloc, n->slot(n->hi),
+                                   std::move(*n->slot(n->hi - 1)));
+            std::move_backward(n->slot(i), n->slot(n->hi - 1),
+                               n->slot(n->hi));
+            *n->slot(i) = std::move(value);
+        }
+        n->hi++;
+    }
+
+    // moves [lo, i) one slot left and puts value into slot i - 1
+    void shift_left(node* n, std::size_t i, T& value) {
+        if (i == n->lo) {
+            node_traits::construct(alloc, n->slot(i - 1), std::move(value));
+        } else {
+            node_traits::construct(alloc, n->slot(n->lo - 1),
+                                   std::move(*n->slot(n->lo)));
+            std::move(n->slot(n->lo + 1), n->slot(i), n->slot(n->lo));
+            *n->slot(i - 1) = std::move(value);
+        }
+        n->lo--;
+    }
+
+    // moves the elements of right, the node after left, behind those of
+    // left, sliding them to the front of left first if needed, and frees
+    // right; both together must fit into one node
+    void absorb(node* left, node* right) {
+        if (left->hi + right->size() > N) {
+            std::size_t k = 0;
+            for (std::size_t j = left->lo; j < left->hi; j++, k++) {
+                node_traits::construct(alloc, left->slot(k),
+                                       std::move(*left->slot(j)));
+                node_traits::destroy(alloc, left->slot(j));
+            }
+            left->lo = 0;
+            left->hi = k;
+        }
+        for (; right->lo < right->hi; right->lo++) {
+            node_traits::construct(alloc, left->slot(left->hi),
+                                   std::move(*right->slot(right->lo)));
+            left->hi++;
+            node_traits::destroy(alloc, right->slot(right->lo));
+        }
+        destroy_node(right);
+    }
+
+    // moves the upper half of a full node into a new node after it
+    void split(node* n) {
+        node* right = create_node(n, n->next, 0);
+        std::size_t mid = n->lo + N / 2;
+        for (std::size_t i = mid; i < n->hi; i++) {
+            node_traits::construct(alloc, right->slot(right->hi++),
+                                   std::move(*n->slot(i)));
+            node_traits::destroy(alloc, n->slot(i));
+        }
+        n->hi = mid;
+    }
+
+    void swap_nodes(unrolled_list& other) noexcept {
+        auto a_left = loop.prev;
+        auto a_right = loop.next;
+
+        auto b_left = other.loop.prev;
+        auto b_right = other.loop.next;
+
+        a_left->next = &other.loop;
+        a_right->prev = &other.loop;
+
+        b_left->next = &loop;
+        b_right->prev = &loop;
+
+        std::swap(loop, other.loop);
+        std::swap(count, other.count);
+    }
+
+    void swap_allocator(unrolled_list& other, std::true_type) noexcept {
+        using std::swap;
+        swap(alloc, other.alloc);
+    }
+    void swap_allocator(unrolled_list&, std::false_type) noexcept {}
+
+    void move_allocator(unrolled_list& other, std::true_type) noexcept {
+        alloc = std::move(other.alloc);
+    }
+    void move_allocator(unrolled_list&, std::false_type) noexcept {}
+
+    // the nodes of other can be adopted as they are
+    void move_assign(unrolled_list& other, std::true_type) noexcept {
+        clear();
+        swap_nodes(other);
+        move_allocator(
+            other,
+            typename node_traits::propagate_on_container_move_assignment());
+    }
+
+    void move_assign(unrolled_list& other, std::false_type) {
+        if (alloc == other.alloc) {
+            move_assign(other, std::true_type());
+            return;
+        }
+        clear();
+        for (auto& x : other) {
+            push_back(std::move(x));
+        }
+        other.clear();
+    }
+};
+
+template <typename U, std::size_t M, typename A>
+void swap(unrolled_list<U, M, A>& a, unrolled_list<U, M, A>& b) noexcept {
+    a.swap_nodes(b);
+    a.swap_allocator(b, typename unrolled_list<U, M, A>::node_traits::
+                            propagate_on_container_swap());
+}
+
+}  // namespace my
+
+#endif  // MY_UNROLLED_LIST
@@ -0,0 +1,218 @@
+#ifndef MY_WORK_STEALING_DEQUE
+#define MY_WORK_STEALING_DEQUE
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace my {
+
+// Chase-Lev work-stealing deque: one owner thread pushes and pops at the
+// bottom, any number of thieves steal from the top. Instead of one
+// circular array that is resized, element i lives in the block of
+// BlockSize slots whose base is the multiple of BlockSize below it, and
+// the blocks form a list, so the deque grows a block at a time and never
+// copies its elements.
+//
+// The owner retires a block once every index in it is below top. Thieves
+// announce themselves in active_thieves before looking up a block; a
+// retired block is reused only when the owner sees no thief inside, so no
+// thief can read a block that is being refilled. While thieves keep
+// stealing, retired blocks therefore pile up; at the next quiet moment up
+// to max_spare of them are kept for reuse and the rest are freed, so the
+// memory shrinks back a block at a time. A slot may be read by a
+// thief while the owner pops it, which is why T must be trivially copyable:
+// slots are atomics and the loser of the race discards its copy.
+template <typename T, std::size_t BlockSize = 256>
+class work_stealing_deque {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "elements are read and discarded by racing threads");
+    static_assert(BlockSize > 0, "a block must hold an element");
+
+   private:
+    using index = std::int64_t;
+
+    struct block {
+        std::atomic<T> slots[BlockSize];
+        std::atomic<block*> next{nullptr};
+        block* prev = nullptr;  // owner only
+        index base = 0;
+    };
+
+    alignas(64) std::atomic<index> top{0};
+    std::atomic<block*> front;
+    std::atomic<std::size_t> active_thieves{0};
+
+    // owner state
+    alignas(64) std::atomic<index> bottom{0};
+    block* back;  // the block of the last pushed index
+    std::vector<block*> retired;
+    std::vector<block*> spare;
+
+    static constexpr index block_size = static_cast<index>(BlockSize);
+    static constexpr std::size_t max_spare = 4;
+
+    // the owner's block for i, which must not be below top
+    block* owner_block(index i) {
+        while (i < back->base) {
+            back = back->prev;
+        }
+        while (i >= back->base + block_size) {
+            block* next = back->next.load(std::memory_order_relaxed);
+            if (next == nullptr) {
+                next = new_block(back->base + block_size);
+                next->prev = back;
+                back->next.store(next, std::memory_order_release);
+            }
+            back = next;
+        }
+        return back;
+    }
+
+    block* new_block(index base) {
+        retire_consumed();
+        block* b;
+        if (spare.empty()) {
+            b = new block;
+        } else {
+            b = spare.back();
+            spare.pop_back();
+            b->next.store(nullptr, std::memory_order_relaxed);
+            b->prev = nullptr;
+        }
+        b->base = base;
+        return b;
+    }
+
+    // unlinks the blocks whose indices are all below top and, once no thief
+    // can hold a pointer to them, keeps max_spare of them and frees the rest
+    void retire_consumed() {
+        block* f = front.load(std::memory_order_relaxed);
+        index t = top.load(std::memory_order_acquire);
+        while (f != back && t >= f->base + block_size) {
+            block* next = f->next.load(std::memory_order_relaxed);
+            next->prev = nullptr;
+            front.store(next);
+            retired.push_back(f);
+            f = next;
+        }
+        if (!retired.empty() && active_thieves.load() == 0) {
+            for (block* p : retired) {
+                if (spare.size() < max_spare) {
+                    spare.push_back(p);
+                } else {
+                    delete p;
+                }
+            }
+            retired.clear();
+        }
+    }
+
+    // counts a thief in for as long as it may dereference a block
+    struct thief_gate {
+        std::atomic<std::size_t>& count;
+        explicit thief_gate(std::atomic<std::size_t>& c) : count(c) {
+            count.fetch_add(1);
+        }
+        ~thief_gate() { count.fetch_sub(1, std::memory_order_release); }
+    };
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    work_stealing_deque() : back(new block) {
+        front.store(back, std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(work_stealing_deque const&) = delete;
+    work_stealing_deque& operator=(work_stealing_deque const&) = delete;
+
+    // no other thread may use the deque any more
+    ~work_stealing_deque() {
+        block* b = front.load(std::memory_order_relaxed);
+        while (b != nullptr) {
+            block* next = b->next.load(std::memory_order_relaxed);
+            delete b;
+            b = next;
+        }
+        for (block* p : retired) {
+            delete p;
+        }
+        for (block* p : spare) {
+            delete p;
+        }
+    }
+
+    // owner only
+    void push(T value) {
+        index b = bottom.load(std::memory_order_relaxed);
+        block* blk = owner_block(b);
+        blk->slots[b - blk->base].store(value, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // owner only: takes the most recently pushed element; false if empty
+    bool pop(T& out) {
+        index b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        index t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        block* blk = owner_block(b);
+        out = blk->slots[b - blk->base].load(std::memory_order_relaxed);
+        if (t < b) {
+            return true;
+        }
+        // the last element: race the thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    // any thread: takes the least recently pushed element; false if empty
+    // or if another thread won the race for it
+    bool steal(T& out) {
+        thief_gate gate(active_thieves);
+        index t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        index b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        block* blk = front.load();
+        while (t >= blk->base + block_size) {
+            blk = blk->next.load(std::memory_order_acquire);
+        }
+        if (t < blk->base) {
+            // t was stolen and its block retired meanwhile
+            return false;
+        }
+        T value = blk->slots[t - blk->base].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+    // a snapshot, exact only when no other thread works on the deque
+    size_type size() const noexcept {
+        index b = bottom.load(std::memory_order_relaxed);
+        index t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_type>(b - t) : 0;
+    }
+    bool empty() const noexcept { return size() == 0; }
+};
+
+}  // namespace my
+
+#endif  // MY_WORK_STEALING_DEQUE
@@ -0,0 +1,371 @@
+#ifndef MY_XOR_LIST
+#define MY_XOR_LIST
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+// Doubly linked list that stores one link word per node, the address of the
+// previous node XOR the address of the next one; the ends link to null.
+// An iterator carries the previous node next to the current one, which is
+// what it takes to step in either direction. Inserting or erasing rewrites
+// the links of both neighbours, so it invalidates the iterators to the
+// element that follows the position, not just those to the erased element.
+template <typename T, typename Alloc = std::allocator<T>>
+class xor_list {
+   private:
+    struct node {
+        std::uintptr_t link;
+        T value;
+
+        template <typename... Args>
+        node(std::uintptr_t l, Args&&... args)
+            : link(l), value(std::forward<Args>(args)...) {}
+    };
+
+    using node_allocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    node* head = nullptr;
+    node* tail = nullptr;
+    std::size_t count = 0;
+    node_allocator alloc;
+
+    static std::uintptr_t bits(node const* p) {
+        return reinterpret_cast<std::uintptr_t>(p);
+    }
+
+    // the neighbour of p on the other side from from
+    static node* other(node const* p, node const* from) {
+        return reinterpret_cast<node*>(p->link ^ bits(from));
+    }
+
+    template <typename U>
+    struct xor_iterator;
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+    using iterator = xor_iterator<T>;
+    using const_iterator = xor_iterator<T const>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    xor_list() noexcept(noexcept(node_allocator())) : alloc() {}
+
+    explicit xor_list(Alloc const& a) noexcept : alloc(a) {}
+
+    xor_list(std::initializer_list<T> init_list, Alloc const& a = Alloc())
+        : xor_list(a) {
+        for (auto const& x : init_list) {
+            push_back(x);
+        }
+    }
+
+    xor_list(xor_list const& other)
+        : alloc(node_traits::select_on_container_copy_construction(
+              other.alloc)) {
+        try {
+            for (auto const& x : other) {
+                push_back(x);
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    xor_list(xor_list&& other) noexcept : alloc(std::move(other.alloc)) {
+        swap_nodes(other);
+    }
+
+    xor_list& operator=(xor_list const& other) {
+        if (this != &other) {
+            using propagate =
+                typename node_traits::propagate_on_container_copy_assignment;
+            xor_list tmp(Alloc(propagate::value ? other.alloc : alloc));
+            for (auto const& x : other) {
+                tmp.push_back(x);
+            }
+            swap_nodes(tmp);
+            swap_allocator(tmp, propagate());
+        }
+        return *this;
+    }
+
+    xor_list& operator=(xor_list&& other) noexcept(
+        node_traits::propagate_on_container_move_assignment::value ||
+        node_traits::is_always_equal::value) {
+        if (this != &other) {
+            move_assign(
+                other,
+                std::integral_constant<
+                    bool,
+                    node_traits::propagate_on_container_move_assignment::value ||
+                        node_traits::is_always_equal::value>());
+        }
+        return *this;
+    }
+
+    ~xor_list() { clear(); }
+
+    allocator_type get_allocator() const { return Alloc(alloc); }
+
+   private:
+    template <typename U>
+    struct xor_iterator {
+       public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = typename std::remove_const<U>::type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U*;
+        using reference = U&;
+
+        friend class xor_list;
+        xor_iterator() = default;
+        xor_iterator(xor_iterator<T> const& other)
+            : prev(other.prev), cur(other.cur) {}
+
+        xor_iterator& operator++() {
+            node* next = other(cur, prev);
+            prev = cur;
+            cur = next;
+            return *this;
+        }
+        xor_iterator operator++(int) {
+            xor_iterator old(*this);
+            ++*this;
+            return old;
+        }
+        xor_iterator& operator--() {
+            node* before = other(prev, cur);
+            cur = prev;
+            prev = before;
+            return *this;
+        }
+        xor_iterator operator--(int) {
+            xor_iterator old(*this);
+            --*this;
+            return old;
+        }
+
+        U& operator*() const { return cur->value; }
+        U* operator->() const { return &cur->value; }
+
+        template <typename Z>
+        bool operator==(xor_iterator<Z> const& other) const {
+            return cur == other.cur;
+        }
+        template <typename Z>
+        bool operator!=(xor_iterator<Z> const& other) const {
+            return cur != other.cur;
+        }
+
+       private:
+        xor_iterator(node* p, node* c) : prev(p), cur(c) {}
+
+        node* prev = nullptr;
+        node* cur = nullptr;
+
+        template <typename Z>
+        friend struct xor_iterator;
+    };
+
+   public:
+    iterator begin() { return iterator(nullptr, head); }
+    const_iterator begin() const { return const_iterator(nullptr, head); }
+    iterator end() { return iterator(tail, nullptr); }
+    const_iterator end() const { return const_iterator(tail, nullptr); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const { return head == nullptr; }
+    size_type size() const noexcept { return count; }
+
+    T& front() {
+        assert(!empty());
+        return head->value;
+    }
+    T const& front() const {
+        assert(!empty());
+        return head->value;
+    }
+    T& back() {
+        assert(!empty());
+        return tail->value;
+    }
+    T const& back() const {
+        assert(!empty());
+        return tail->value;
+    }
+
+    void push_back(T const& value) { emplace(end(), value); }
+    void push_back(T&& value) { emplace(end(), std::move(value)); }
+    void push_front(T const& value) { emplace(begin(), value); }
+    void push_front(T&& value) { emplace(begin(), std::move(value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        return *emplace(end(), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    T& emplace_front(Args&&... args) {
+        return *emplace(begin(), std::forward<Args>(args)...);
+    }
+
+    void pop_back() {
+        assert(!empty());
+        erase(const_iterator(other(tail, nullptr), tail));
+    }
+    void pop_front() {
+        assert(!empty());
+        erase(begin());
+    }
+
+    iterator insert(const_iterator pos, T const& value) {
+        return emplace(pos, value);
+    }
+    iterator insert(const_iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        node* prev = pos.prev;
+        node* next = pos.cur;
+        node* p = node_traits::allocate(alloc, 1);
+        try {
+            node_traits::construct(alloc, p, bits(prev) ^ bits(next),
+                                   std::forward<Args>(args)...);
+        } catch (...) {
+            node_traits::deallocate(alloc, p, 1);
+            throw;
+        }
+        if (prev != nullptr) {
+            prev->link ^= bits(next) ^ bits(p);
+        } else {
+            head = p;
+        }
+        if (next != nullptr) {
+            next->link ^= bits(prev) ^ bits(p);
+        } else {
+            tail = p;
+        }
+        count++;
+        return iterator(prev, p);
+    }
+
+    iterator erase(const_iterator pos) {
+        assert(pos.cur != nullptr);
+        node* prev = pos.prev;
+        node* p = pos.cur;
+        node* next = other(p, prev);
+        if (prev != nullptr) {
+            prev->link ^= bits(p) ^ bits(next);
+        } else {
+            head = next;
+        }
+        if (next != nullptr) {
+            next->link ^= bits(p) ^ bits(prev);
+        } else {
+            tail = prev;
+        }
+        destroy_node(p);
+        count--;
+        return iterator(prev, next);
+    }
+
+    void clear() noexcept {
+        node* prev = nullptr;
+        node* cur = head;
+        while (cur != nullptr) {
+            node* next = other(cur, prev);
+            destroy_node(cur);
+            prev = cur;
+            cur = next;
+        }
+        head = tail = nullptr;
+        count = 0;
+    }
+
+    // O(1): the links read the same in both directions
+    void reverse() noexcept { std::swap(head, tail); }
+
+    template <typename U, typename A>
+    friend void swap(xor_list<U, A>& a, xor_list<U, A>& b) noexcept;
+
+   private:
+    void destroy_node(node* p) noexcept {
+        node_traits::destroy(alloc, p);
+        node_traits::deallocate(alloc, p, 1);
+    }
+
+    void swap_nodes(xor_list& other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(count, other.count);
+    }
+
+    void swap_allocator(xor_list& other, std::true_type) noexcept {
+        using std::swap;
+        swap(alloc, other.alloc);
+    }
+    void swap_allocator(xor_list&, std::false_type) noexcept {}
+
+    void move_allocator(xor_list& other, std::true_type) noexcept {
+        alloc = std::move(other.alloc);
+    }
+    void move_allocator(xor_list&, std::false_type) noexcept {}
+
+    // the nodes of other can be adopted as they are
+    void move_assign(xor_list& other, std::true_type) noexcept {
+        clear();
+        swap_nodes(other);
+        move_allocator(
+            other,
+            typename node_traits::propagate_on_container_move_assignment());
+    }
+
+    void move_assign(xor_list& other, std::false_type) {
+        if (alloc == other.alloc) {
+            move_assign(other, std::true_type());
+            return;
+        }
+        clear();
+        for (auto& x : other) {
+            push_back(std::move(x));
+        }
+        other.clear();
+    }
+};
+
+template <typename U, typename A>
+void swap(xor_list<U, A>& a, xor_list<U, A>& b) noexcept {
+    using traits = typename xor_list<U, A>::node_traits;
+    a.swap_nodes(b);
+    a.swap_allocator(b, typename traits::propagate_on_container_swap());
+}
+
+}  // namespace my
+
+#endif  // MY_XOR_LIST